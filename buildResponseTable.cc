@@ -0,0 +1,150 @@
+/// \file buildResponseTable.cc
+/// \brief Builds the tabulated DOM photon response used by table-lookup mode
+
+#include "WaterTankDetectorConstruction.hh"
+#include "WaterTankPhotonPropagator.hh"
+#include "WaterTankResponseTable.hh"
+
+#include "G4LogicalVolume.hh"
+#include "G4Material.hh"
+#include "G4MaterialPropertiesTable.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+/// Standalone tool that precomputes the DOM response for the current tank
+/// geometry. It builds the same detector as exampleWaterTank, then traces
+/// photons with WaterTankPhotonPropagator from every (r, z, cos theta, phi,
+/// energy) cell and records how many reach the DOM and when.
+///
+/// Usage: buildResponseTable <output file> [photons per cell] [seed]
+int main(int argc, char** argv)
+{
+  if (argc < 2) {
+    G4cerr << "Usage: " << argv[0] << " <output file> [photons per cell] [seed]" << G4endl;
+    return 1;
+  }
+  const G4String fileName = argv[1];
+  const G4long photonsPerCell = (argc > 2) ? std::atol(argv[2]) : 200;
+  const G4long seed = (argc > 3) ? std::atol(argv[3]) : 12345;
+  if (photonsPerCell <= 0) {
+    G4cerr << "Photons per cell must be positive" << G4endl;
+    return 1;
+  }
+  G4Random::setTheSeed(seed);
+
+  // Build the geometry and optical tables exactly as the simulation does. No
+  // run manager is needed; we only read solids and material properties.
+  auto detector = new WaterTankDetectorConstruction();
+  detector->Construct();
+
+  WaterTankPhotonPropagator propagator;
+  if (!propagator.Configure(detector)) {
+    G4cerr << "Water optical properties or tank geometry not available" << G4endl;
+    return 1;
+  }
+  const WaterTankOpticalGeometry& geometry = propagator.GetGeometry();
+
+  // The table is indexed in cylindrical coordinates around the tank axis,
+  // which is only complete if the DOM sits on that axis.
+  if (geometry.GetDOMCenter().perp() > 1.*um) {
+    G4cerr << "The DOM is off the tank axis; the response table assumes axial symmetry" << G4endl;
+    return 1;
+  }
+
+  const G4MaterialPropertiesTable* waterMPT
+    = detector->GetWaterLogicalVolume()->GetMaterial()->GetMaterialPropertiesTable();
+  const auto refractiveIndex = waterMPT->GetProperty("RINDEX");
+
+  // Binning: ~5 cm in r and z, ~0.1 in cos theta, 15 degrees in phi, one bin
+  // per RINDEX interval in energy, and 0.5 ns in arrival delay. The longest
+  // unscattered path across the tank takes ~10 ns; the tail beyond timeMax is
+  // accumulated in the last bin.
+  WaterTankResponseTable::Binning binning;
+  binning.nR        = 18;
+  binning.nZ        = 18;
+  binning.nCos      = 20;
+  binning.nPhi      = 12;
+  binning.nEnergy   = G4int(refractiveIndex->GetVectorLength()) - 1;
+  binning.nTime     = 60;
+  binning.rMax      = geometry.GetTankRadius();
+  binning.zMin      = -geometry.GetTankHalfHeight();
+  binning.zMax      = geometry.GetTankHalfHeight();
+  binning.energyMin = refractiveIndex->GetMinEnergy();
+  binning.energyMax = refractiveIndex->GetMaxEnergy();
+  binning.timeMax   = 30.*ns;
+
+  WaterTankResponseTable table;
+  table.Allocate(binning, geometry.GetDOMCenter().z(), geometry.GetDOMRadius(), photonsPerCell);
+
+  const G4double dR      = binning.rMax / binning.nR;
+  const G4double dZ      = (binning.zMax - binning.zMin) / binning.nZ;
+  const G4double dCos    = 2. / binning.nCos;
+  const G4double dPhi    = pi / binning.nPhi;
+  const G4double dEnergy = (binning.energyMax - binning.energyMin) / binning.nEnergy;
+  const G4double dTime   = binning.timeMax / binning.nTime;
+
+  std::vector<G4long> timeCounts(binning.nTime);
+
+  for (G4int iR = 0; iR < binning.nR; ++iR) {
+    G4cout << "Radial bin " << iR + 1 << "/" << binning.nR << G4endl;
+    for (G4int iZ = 0; iZ < binning.nZ; ++iZ) {
+      for (G4int iCos = 0; iCos < binning.nCos; ++iCos) {
+        for (G4int iPhi = 0; iPhi < binning.nPhi; ++iPhi) {
+          const std::size_t cell = table.DirectionCell(iR, iZ, iCos, iPhi);
+          float* arrival = table.ArrivalOf(cell);
+          std::fill(timeCounts.begin(), timeCounts.end(), 0);
+          G4long arrivals = 0;
+
+          for (G4int iEnergy = 0; iEnergy < binning.nEnergy; ++iEnergy) {
+            G4long emitted = 0;
+            G4long arrivedInBin = 0;
+            for (G4long n = 0; n < photonsPerCell; ++n) {
+              // Uniform in the cell volume: r^2 is uniform for a ring. The
+              // radial direction is +x, so phi is the direction's azimuth.
+              const G4double r0 = iR * dR;
+              const G4double r = std::sqrt(r0*r0 + G4UniformRand() * (2.*r0 + dR) * dR);
+              WaterTankPhotonPropagator::Photon photon;
+              photon.position.set(r, 0., binning.zMin + (iZ + G4UniformRand()) * dZ);
+              if (!geometry.IsInWater(photon.position)) continue;
+              ++emitted;
+
+              const G4double cosTheta = -1. + (iCos + G4UniformRand()) * dCos;
+              const G4double sinTheta = std::sqrt(std::max(0., 1. - cosTheta*cosTheta));
+              const G4double phi = (iPhi + G4UniformRand()) * dPhi;
+              photon.direction.set(sinTheta*std::cos(phi), sinTheta*std::sin(phi), cosTheta);
+              photon.energy = binning.energyMin + (iEnergy + G4UniformRand()) * dEnergy;
+              photon.time = 0.;
+
+              if (!propagator.TransportToDOM(photon)) continue;
+              ++arrivedInBin;
+              const G4int iTime = std::min(G4int(photon.time / dTime), binning.nTime - 1);
+              ++timeCounts[iTime];
+            }
+            arrival[iEnergy] = emitted > 0 ? float(G4double(arrivedInBin) / emitted) : 0.f;
+            arrivals += arrivedInBin;
+          }
+
+          // Cumulative delay distribution, normalized to one if anything arrived.
+          float* cdf = table.TimeCDFOf(cell);
+          G4long cumulative = 0;
+          for (G4int iTime = 0; iTime < binning.nTime; ++iTime) {
+            cumulative += timeCounts[iTime];
+            cdf[iTime] = arrivals > 0 ? float(G4double(cumulative) / arrivals) : 0.f;
+          }
+        }
+      }
+    }
+  }
+
+  if (!table.Write(fileName)) {
+    G4cerr << "Failed to write " << fileName << G4endl;
+    return 1;
+  }
+  G4cout << "Wrote DOM response table " << fileName << G4endl;
+  return 0;
+}
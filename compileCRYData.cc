@@ -0,0 +1,35 @@
+/// \file compileCRYData.cc
+/// \brief Compiles the CRY cosmics_*.data tables into binary caches
+
+#include "CRYData.h"
+
+#include <iostream>
+
+/// Standalone tool that converts CRY data files into the binary cache read
+/// by CRYData (cosmics_0.data -> cosmics_0.bin, next to the text file). The
+/// cache holds the parsed binnings, pdfs and cdfs, so CRYSetup maps it instead
+/// of parsing the text. It records the checksum of its text file, and CRYData
+/// falls back to the text whenever the two no longer match, so rerunning the
+/// tool is only needed to get the fast path back after editing a table.
+///
+/// Usage: compileCRYData <data file> [more data files...]
+int main(int argc, char** argv)
+{
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <data file> [more data files...]" << std::endl;
+    return 1;
+  }
+
+  int failures = 0;
+  for (int i = 1; i < argc; ++i) {
+    const std::string dataFile = argv[i];
+    const std::string cacheFile = CRYData::cacheFile(dataFile);
+    CRYData data(dataFile);
+    if (data.writeCache(cacheFile)) {
+      std::cout << dataFile << " -> " << cacheFile << std::endl;
+    } else {
+      ++failures;
+    }
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -75,18 +75,18 @@ public:
   void print(std::ostream& o, bool printData=false);
 
   // The function key
-  std::string name() {return _name;}
+  std::string name() const {return _name;}
 
   // The function type
-  CRYFunctionDict::functype type() {return _type;}
+  CRYFunctionDict::functype type() const {return _type;}
 
   // Direct access to the parameter vector
-  const std::vector<double>* params() {return _params;}
+  const std::vector<double>* params() const {return _params;}
 
   // Evaluate the function given an input or vector of inputs
   // These are defined in the derived classes
-  virtual double value(double x)=0;
-  virtual double value(std::vector<double> x)=0;
+  virtual double value(double x) const=0;
+  virtual double value(std::vector<double> x) const=0;
 
 protected:
 
@@ -73,7 +73,7 @@ public:
   void print(std::ostream& o, bool printData=false);
 
   // get the key
-  std::string name() {return _name;}
+  std::string name() const {return _name;}
 
 protected:
   std::string _paramStr;
@@ -104,6 +104,12 @@ CRYBinning::CRYBinning(std::string data) {
   _size=_bins->size();
 }
 
+CRYBinning::CRYBinning(std::string name, const std::vector<double>& bins) {
+  _name=name;
+  _bins=new std::vector<double>(bins);
+  _size=_bins->size();
+}
+
 void CRYBinning::print(std::ostream& o, bool printData) {
   o << "Binning name: " << _name << std::endl;
   o << "  Bin   Edge location:\n";
@@ -114,7 +120,7 @@ void CRYBinning::print(std::ostream& o, bool printData) {
   }
 }
 
-int CRYBinning::bin(double value) {
+int CRYBinning::bin(double value) const {
   if ( value < (*_bins)[0] ) {
     std::cerr << "CRY::CRYBinning " << name() << ": Datum is in no bin. Stopping\n " << value << std::endl;
     assert(0);
@@ -69,6 +69,9 @@ public:
   // than the # of bins.
   CRYBinning(std::string data="");
 
+  //Constructor from already parsed bin edges (binary cache of CRYData)
+  CRYBinning(std::string name, const std::vector<double>& bins);
+
   //Destructor. CRYBinning owns _bins so delete it
   ~CRYBinning() {delete _bins; _bins=0;}
 
@@ -77,7 +80,7 @@ public:
   void print(std::ostream& o, bool printData=false);
 
   //Returns the key 
-  std::string name() {return _name;}
+  std::string name() const {return _name;}
 
   //Direct access to the binning defintion
   const std::vector<double>* bins() const {return _bins;}
@@ -85,11 +88,11 @@ public:
   //Given x (value), determine the corresponding bin
   // Return value is 0..N
   // x is outside of the defined range, an assert will be thrown
-  int bin(double value);
+  int bin(double value) const;
 
   // Get the boundaries of this binning
-  double min() {return (*_bins)[0];}
-  double max() {return (*_bins)[_bins->size()-1];}
+  double min() const {return (*_bins)[0];}
+  double max() const {return (*_bins)[_bins->size()-1];}
 
 private:
   //Key for this binning structur
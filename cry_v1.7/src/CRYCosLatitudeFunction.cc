@@ -49,6 +49,6 @@ CRYCosLatitudeFunction::CRYCosLatitudeFunction(std::string name, std::string dat
 
   // Evaluate the function given an input or vector of inputs
   // These are defined in the derived classes
-double CRYCosLatitudeFunction::value(double x) {
+double CRYCosLatitudeFunction::value(double x) const {
   return (*_params)[0]*pow(cos((M_PI/180.0)*x),(*_params)[1]);
 }
@@ -51,11 +51,127 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <assert.h>
 #include <fstream>
 #include <sstream>
+#include <stdint.h>
+#include <stdio.h>
 #include <string.h>  // For Ubuntu Linux
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Binary cache layout, in host byte order (the header records which):
+//
+//   header (48 bytes): magic "CRYCACHE", version, byte order mark,
+//     size and checksum of the text file, size and checksum of the
+//     payload that follows
+//   payload: one record per datum, each a multiple of 8 bytes so that
+//     the doubles stay aligned in the mapping
+//     function/parameter/paramInt: kind, length | definition text
+//     binning: kind, name length | number of edges | name | edges
+//     pdf: kind, type | name length, key length | min | max | rows |
+//          name | key | row lengths | values of all rows | cdfs of all rows
+//
+// Strings are padded to 8 bytes. The pdf limits are stored as held by
+// CRYPdf (log10 for log pdfs) and the cdfs as computed from the text,
+// so a pdf loaded from the cache is bit for bit the one read from text.
+namespace {
+
+  const char cacheMagic[8]={'C','R','Y','C','A','C','H','E'};
+  const uint32_t cacheVersion=1;
+  const uint32_t cacheByteOrder=0x01020304;
+
+  enum cacheKind { cacheFunction=1, cacheParameter, cacheParamInt,
+		   cacheBinning, cachePdf };
+
+  struct cacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t sourceSize;
+    uint64_t sourceChecksum;
+    uint64_t payloadSize;
+    uint64_t payloadChecksum;
+  };
+
+  // FNV-1a over 64-bit words, then over the remaining bytes
+  uint64_t checksum(const char *data, size_t size) {
+    const uint64_t prime=1099511628211ULL;
+    uint64_t hash=14695981039346656037ULL;
+    size_t i=0;
+    for ( ; i+8<=size; i+=8 ) {
+      uint64_t word;
+      memcpy(&word,data+i,8);
+      hash=(hash^word)*prime;
+    }
+    for ( ; i<size; i++ ) hash=(hash^(unsigned char)data[i])*prime;
+    return hash;
+  }
+
+  // Read-only mapping of a whole file; data is 0 if it cannot be mapped
+  struct mappedFile {
+    const char *data;
+    size_t size;
+    mappedFile(std::string name) : data(0), size(0) {
+      int fd=open(name.c_str(),O_RDONLY);
+      if ( fd<0 ) return;
+      struct stat st;
+      if ( fstat(fd,&st)==0 && st.st_size>0 ) {
+	void *p=mmap(0,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+	if ( p!=MAP_FAILED ) { data=(const char*)p; size=st.st_size; }
+      }
+      close(fd);
+    }
+    ~mappedFile() { if ( data ) munmap((void*)data,size); }
+  };
+
+  size_t padded(size_t n) { return (n+7)&~size_t(7); }
+
+  // Appends records to the payload
+  struct cacheWriter {
+    std::string out;
+    void pair32(uint32_t a, uint32_t b) {
+      out.append((const char*)&a,4); out.append((const char*)&b,4);
+    }
+    void u64(uint64_t v) { out.append((const char*)&v,8); }
+    void f64(double v) { out.append((const char*)&v,8); }
+    void str(const std::string &s) { out.append(s); out.append(padded(s.size())-s.size(),'\0'); }
+    void doubles(const std::vector<double> &v) {
+      if ( !v.empty() ) out.append((const char*)&v[0],8*v.size());
+    }
+  };
+
+  // Walks the mapped payload; ok turns false on reading past its end
+  struct cacheReader {
+    const char *pos;
+    const char *end;
+    bool ok;
+    cacheReader(const char *begin, const char *stop) : pos(begin), end(stop), ok(true) {}
+    const char *take(size_t n) {
+      n=padded(n);
+      if ( !ok || size_t(end-pos)<n ) { ok=false; return 0; }
+      const char *p=pos;
+      pos+=n;
+      return p;
+    }
+    void pair32(uint32_t &a, uint32_t &b) {
+      const char *p=take(8);
+      if ( p ) { memcpy(&a,p,4); memcpy(&b,p+4,4); } else a=b=0;
+    }
+    uint64_t u64() { uint64_t v=0; const char *p=take(8); if ( p ) memcpy(&v,p,8); return v; }
+    double f64() { double v=0; const char *p=take(8); if ( p ) memcpy(&v,p,8); return v; }
+    std::string str(size_t n) { const char *p=take(n); return p ? std::string(p,n) : std::string(); }
+    const char *words(uint64_t n) {
+      if ( n>uint64_t(end-pos)/8 ) { ok=false; return 0; }
+      return take(8*n);
+    }
+    const double *doubles(uint64_t n) { return (const double*)words(n); }
+  };
+
+}
 
 CRYData::CRYData(std::string file) {
   _file=file;
-  bool readOk=read();
+  bool readOk=readCache(cacheFile(_file)) || read();
   if (!readOk) {
     std::cerr << "CRY::CRYData: Error reading " << _file << "....  Stopping\n";
     assert(0);
@@ -63,8 +179,6 @@ CRYData::CRYData(std::string file) {
 }
 
 bool CRYData::read() {
-  CRYFunctionDict fDict;
-
   //  std::cout << "CRY::CRYData: Reading data file " << _file << std::endl;
 
   std::ifstream file;
@@ -104,7 +218,7 @@ bool CRYData::read() {
      std::getline(iss2,token2,';');
     
     if ( 0==strncmp(key.c_str(),"function",8)) {
-      _funcs.push_back(fDict.function(token2));
+      addTextEntry(cacheFunction,token2);
     }
 
     if ( 0==strncmp(key.c_str(),"pdf",3)) {
@@ -116,11 +230,11 @@ bool CRYData::read() {
      }
 
     if ( 0==strncmp(key.c_str(),"parameter",9)) {
-       _params.push_back(new CRYParameter(token2));
+       addTextEntry(cacheParameter,token2);
      }
 
     if ( 0==strncmp(key.c_str(),"paramInt",8)) {
-       _paramInts.push_back(new CRYParamI(token2));
+       addTextEntry(cacheParamInt,token2);
      }
   }
 
@@ -129,6 +243,179 @@ bool CRYData::read() {
   return true;
 }
 
+void CRYData::addTextEntry(int kind, std::string definition) {
+  if ( kind == cacheFunction ) {
+    CRYFunctionDict fDict;
+    _funcs.push_back(fDict.function(definition));
+  }
+  if ( kind == cacheParameter ) _params.push_back(new CRYParameter(definition));
+  if ( kind == cacheParamInt ) _paramInts.push_back(new CRYParamI(definition));
+  _textEntries.push_back(std::make_pair(kind,definition));
+}
+
+std::string CRYData::cacheFile(std::string file) {
+  std::string::size_type ext=file.rfind(".data");
+  if ( ext != std::string::npos && ext+5 == file.length() ) file.erase(ext);
+  return file+".bin";
+}
+
+bool CRYData::writeCache(std::string cacheFile) {
+  mappedFile source(_file);
+  if ( !source.data ) {
+    std::cerr << "CRY::CRYData: Cannot read " << _file << " to write its cache\n";
+    return false;
+  }
+
+  cacheWriter w;
+  for ( unsigned int i=0; i<_textEntries.size(); i++ ) {
+    w.pair32(_textEntries[i].first,_textEntries[i].second.length());
+    w.str(_textEntries[i].second);
+  }
+  for ( unsigned int i=0; i<_binnings.size(); i++ ) {
+    std::string name=_binnings[i]->name();
+    const std::vector<double> *bins=_binnings[i]->bins();
+    w.pair32(cacheBinning,name.length());
+    w.u64(bins->size());
+    w.str(name);
+    w.doubles(*bins);
+  }
+  for ( unsigned int i=0; i<_pdfs.size(); i++ ) {
+    CRYPdf *pdf=_pdfs[i];
+    const std::vector<std::vector<double> > *params=pdf->params();
+    const std::vector<std::vector<double> > *cdfs=pdf->cdfs();
+    w.pair32(cachePdf,pdf->type());
+    w.pair32(pdf->name().length(),pdf->key().length());
+    w.f64(pdf->storedMin());
+    w.f64(pdf->storedMax());
+    w.u64(params->size());
+    w.str(pdf->name());
+    w.str(pdf->key());
+    for ( unsigned int j=0; j<params->size(); j++ ) w.u64((*params)[j].size());
+    for ( unsigned int j=0; j<params->size(); j++ ) w.doubles((*params)[j]);
+    for ( unsigned int j=0; j<cdfs->size(); j++ ) w.doubles((*cdfs)[j]);
+  }
+
+  cacheHeader header;
+  memcpy(header.magic,cacheMagic,8);
+  header.version=cacheVersion;
+  header.byteOrder=cacheByteOrder;
+  header.sourceSize=source.size;
+  header.sourceChecksum=checksum(source.data,source.size);
+  header.payloadSize=w.out.size();
+  header.payloadChecksum=checksum(w.out.data(),w.out.size());
+
+  // Written under a temporary name and renamed, so that a reader never
+  // maps a partly written cache
+  std::string tmpFile=cacheFile+".tmp";
+  {
+    std::ofstream out(tmpFile.c_str(),std::ios::out|std::ios::binary|std::ios::trunc);
+    out.write((const char*)&header,sizeof(header));
+    out.write(w.out.data(),w.out.size());
+    if ( !out ) {
+      std::cerr << "CRY::CRYData: Cannot write " << tmpFile << std::endl;
+      return false;
+    }
+  }
+  if ( rename(tmpFile.c_str(),cacheFile.c_str()) != 0 ) {
+    std::cerr << "CRY::CRYData: Cannot rename " << tmpFile << " to " << cacheFile << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool CRYData::readCache(std::string cacheFile) {
+  mappedFile cache(cacheFile);
+  if ( !cache.data ) return false;
+
+  // Validate before touching the payload; any mismatch falls back to
+  // reading the text file
+  std::string problem;
+  cacheHeader header;
+  if ( cache.size < sizeof(header) ) problem="truncated";
+  else {
+    memcpy(&header,cache.data,sizeof(header));
+    if ( memcmp(header.magic,cacheMagic,8) != 0 ) problem="not a CRY cache";
+    else if ( header.version != cacheVersion ) problem="other cache version";
+    else if ( header.byteOrder != cacheByteOrder ) problem="other byte order";
+    else if ( header.payloadSize != cache.size-sizeof(header) ) problem="truncated";
+    else if ( header.payloadChecksum != checksum(cache.data+sizeof(header),header.payloadSize) )
+      problem="checksum mismatch";
+  }
+  if ( problem.empty() ) {
+    // A cache shipped without its text file is used as is
+    mappedFile source(_file);
+    if ( source.data && ( source.size != header.sourceSize
+			  || checksum(source.data,source.size) != header.sourceChecksum ) )
+      problem="made from another version of the text file";
+  }
+
+  std::vector<std::pair<int,std::string> > textEntries;
+  std::vector<CRYBinning*> binnings;
+  std::vector<CRYPdf*> pdfs;
+  if ( problem.empty() ) {
+    cacheReader r(cache.data+sizeof(header),cache.data+cache.size);
+    while ( r.ok && r.pos < r.end ) {
+      uint32_t kind, length;
+      r.pair32(kind,length);
+      if ( kind == cacheFunction || kind == cacheParameter || kind == cacheParamInt ) {
+	textEntries.push_back(std::make_pair(int(kind),r.str(length)));
+      }
+      else if ( kind == cacheBinning ) {
+	uint64_t nEdges=r.u64();
+	std::string name=r.str(length);
+	const double *edges=r.doubles(nEdges);
+	if ( r.ok ) binnings.push_back(new CRYBinning(name,std::vector<double>(edges,edges+nEdges)));
+      }
+      else if ( kind == cachePdf && length <= CRYPdf::UNKNOWN ) {
+	uint32_t nameLength, keyLength;
+	r.pair32(nameLength,keyLength);
+	double storedMin=r.f64();
+	double storedMax=r.f64();
+	uint64_t nRows=r.u64();
+	std::string name=r.str(nameLength);
+	std::string key=r.str(keyLength);
+	const char *rowLengths=r.words(nRows);
+	uint64_t nValues=0;
+	for ( uint64_t j=0; r.ok && j<nRows; j++ ) {
+	  uint64_t rowLength;
+	  memcpy(&rowLength,rowLengths+8*j,8);
+	  nValues+=rowLength;
+	}
+	const double *values=r.doubles(nValues);
+	const double *cdfValues=r.doubles(nValues);
+	if ( !r.ok ) break;
+	std::vector<std::vector<double> > *params=new std::vector<std::vector<double> >(nRows);
+	std::vector<std::vector<double> > *cdfs=new std::vector<std::vector<double> >(nRows);
+	for ( uint64_t j=0; j<nRows; j++ ) {
+	  uint64_t rowLength;
+	  memcpy(&rowLength,rowLengths+8*j,8);
+	  (*params)[j].assign(values,values+rowLength);
+	  (*cdfs)[j].assign(cdfValues,cdfValues+rowLength);
+	  values+=rowLength;
+	  cdfValues+=rowLength;
+	}
+	pdfs.push_back(new CRYPdf(name,key,CRYPdf::pdfType(length),storedMin,storedMax,params,cdfs));
+      }
+      else r.ok=false;
+    }
+    if ( !r.ok ) problem="malformed";
+  }
+
+  if ( !problem.empty() ) {
+    for ( unsigned int i=0; i<binnings.size(); i++ ) delete binnings[i];
+    for ( unsigned int i=0; i<pdfs.size(); i++ ) delete pdfs[i];
+    std::cerr << "CRY::CRYData: Ignoring " << cacheFile << " (" << problem
+	      << "), reading " << _file << std::endl;
+    return false;
+  }
+
+  for ( unsigned int i=0; i<textEntries.size(); i++ )
+    addTextEntry(textEntries[i].first,textEntries[i].second);
+  _binnings=binnings;
+  _pdfs=pdfs;
+  return true;
+}
+
 void CRYData::print(std::ostream& o, bool printData) {
   o << "Begin CRYData print ==================================\n";
   o << "Number of functions defined: " << _funcs.size() << std::endl;
@@ -147,37 +434,37 @@ void CRYData::print(std::ostream& o, bool printData) {
   o << "End   CRYData print ==================================\n";
 }
 
-CRYAbsFunction* CRYData::getFunction(std::string name) {
+const CRYAbsFunction* CRYData::getFunction(std::string name) const {
   for ( unsigned int i=0; i<_funcs.size(); i++ )
     if ( _funcs[i]->name() == name ) return _funcs[i];
   return 0;
 
 }
-CRYBinning * CRYData::getBinning(std::string name) {
+const CRYBinning * CRYData::getBinning(std::string name) const {
   for ( unsigned int i=0; i<_binnings.size(); i++ )
     if ( _binnings[i]->name() == name ) return _binnings[i];
   return 0;
 }
-CRYPdf* CRYData::getPdf(std::string name){
+const CRYPdf* CRYData::getPdf(std::string name) const {
   for ( unsigned int i=0; i<_pdfs.size(); i++ )
     if ( _pdfs[i]->name() == name ) return _pdfs[i];
   return 0;
 }
 
-CRYParameter* CRYData::getParameter(std::string name){
+const CRYParameter* CRYData::getParameter(std::string name) const {
   for ( unsigned int i=0; i<_params.size(); i++ )
     if ( _params[i]->name() == name ) return _params[i];
   return 0;
 }
 
-CRYParamI* CRYData::getParamI(std::string name){
+const CRYParamI* CRYData::getParamI(std::string name) const {
   for ( unsigned int i=0; i<_paramInts.size(); i++ )
     if ( _paramInts[i]->name() == name ) return _paramInts[i];
   return 0;
 }
 
 
-std::vector<std::string> CRYData::getParameterList(std::string substr) {
+std::vector<std::string> CRYData::getParameterList(std::string substr) const {
   std::vector<std::string> retVal;
   for ( unsigned int i=0; i<_params.size(); i++ )
     if ( _params[i]->name().substr(0,substr.length()) == substr ) 
@@ -186,7 +473,7 @@ std::vector<std::string> CRYData::getParameterList(std::string substr) {
   return retVal;
 }
 
-std::vector<std::string> CRYData::getParamIList(std::string substr) {
+std::vector<std::string> CRYData::getParamIList(std::string substr) const {
   std::vector<std::string> retVal;
   for ( unsigned int i=0; i<_paramInts.size(); i++ )
     if ( _paramInts[i]->name().substr(0,substr.length()) == substr ) 
@@ -195,7 +482,7 @@ std::vector<std::string> CRYData::getParamIList(std::string substr) {
   return retVal;
 }
 
-std::vector<std::string> CRYData::getBinningList(std::string substr) {
+std::vector<std::string> CRYData::getBinningList(std::string substr) const {
   std::vector<std::string> retVal;
   for ( unsigned int i=0; i<_binnings.size(); i++ )
     if ( _binnings[i]->name().substr(0,substr.length()) == substr ) 
@@ -204,7 +491,7 @@ std::vector<std::string> CRYData::getBinningList(std::string substr) {
   return retVal;
 }
 
-std::vector<std::string> CRYData::getPdfList(std::string substr) {
+std::vector<std::string> CRYData::getPdfList(std::string substr) const {
   std::vector<std::string> retVal;
   for ( unsigned int i=0; i<_pdfs.size(); i++ )
     if ( _pdfs[i]->name().substr(0,substr.length()) == substr ) 
@@ -213,7 +500,7 @@ std::vector<std::string> CRYData::getPdfList(std::string substr) {
   return retVal;
 }
 
-std::vector<std::string> CRYData::getFunctionList(std::string substr) {
+std::vector<std::string> CRYData::getFunctionList(std::string substr) const {
   std::vector<std::string> retVal;
   for ( unsigned int i=0; i<_funcs.size(); i++ )
     if ( _funcs[i]->name().substr(0,substr.length()) == substr ) 
@@ -51,6 +51,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define CRYData_h
 
 #include <string>
+#include <utility>
 #include <vector>
 #include <iostream>
 
@@ -65,8 +66,22 @@ class CRYData {
 public:
   // file containing definition of functions, binnings, etc
   // IMPROVEMENT: Check that file exists!
+  //
+  // If the binary cache of the file (see cacheFile) exists and its
+  // checksums match the cache contents and the text file, the data
+  // are loaded from the cache without any parsing. Otherwise the text
+  // file is read.
   CRYData(std::string file);
 
+  // Binary cache of a data file: cosmics_0.data -> cosmics_0.bin
+  static std::string cacheFile(std::string file);
+
+  // Write the binary cache of this data to cacheFile. The cache
+  // records the size and checksum of the text file it was made from,
+  // so an edited text file is read again instead of a stale cache.
+  // Returns false if the file cannot be written.
+  bool writeCache(std::string cacheFile);
+
   // Call print on all datums. printData=true will print
   // the gory details of each of these data (eg, pdf values
   // for CRYPdf
@@ -74,33 +89,40 @@ public:
 
   // Retrieve a function by name.
   // Returns 0 if not found
-  CRYAbsFunction *getFunction(std::string name);
-  std::vector<std::string> getFunctionList(std::string substr);
+  const CRYAbsFunction *getFunction(std::string name) const;
+  std::vector<std::string> getFunctionList(std::string substr) const;
 
   // Retrieve a binning by name.
   // Returns 0 if not found
-  CRYBinning *getBinning(std::string name);
-  std::vector<std::string> getBinningList(std::string substr);
+  const CRYBinning *getBinning(std::string name) const;
+  std::vector<std::string> getBinningList(std::string substr) const;
 
   // Retrieve a pdf by name.
   // Returns 0 if not found
-  CRYPdf *getPdf(std::string name);
-  std::vector<std::string> getPdfList(std::string substr);
+  const CRYPdf *getPdf(std::string name) const;
+  std::vector<std::string> getPdfList(std::string substr) const;
 
   // Retrieve a parameter by name.
   // Returns 0 if not found
-  CRYParameter *getParameter(std::string name);
-  std::vector<std::string> getParameterList(std::string substr);
+  const CRYParameter *getParameter(std::string name) const;
+  std::vector<std::string> getParameterList(std::string substr) const;
 
   // Retrieve a parameter by name.
   // Returns 0 if not found
-  CRYParamI *getParamI(std::string name);
-  std::vector<std::string> getParamIList(std::string substr);
+  const CRYParamI *getParamI(std::string name) const;
+  std::vector<std::string> getParamIList(std::string substr) const;
 
 private:
   //guts of file reading algorithm
   bool read();
 
+  //load the binary cache; returns false, leaving the lists empty, if
+  //it is missing, damaged, of another version or made from another file
+  bool readCache(std::string cacheFile);
+
+  //create a function, parameter or paramInt from its definition
+  void addTextEntry(int kind, std::string definition);
+
   //list of defined functions
   std::vector<CRYAbsFunction*> _funcs;
 
@@ -114,6 +136,10 @@ private:
   std::vector<CRYParameter*> _params;
   std::vector<CRYParamI*> _paramInts;
 
+  //definitions of the functions, parameters and paramInts in file
+  //order (small; stored as text in the binary cache)
+  std::vector<std::pair<int,std::string> > _textEntries;
+
   //file to read from
   std::string _file;
 };
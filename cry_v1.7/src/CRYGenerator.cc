@@ -61,7 +61,8 @@ CRYGenerator::CRYGenerator(CRYSetup *setup) {
   // random number generator
 
   _setup=setup;
-  CRYData *data=_setup->getData(int(_setup->param(CRYSetup::altitude)+0.1));
+  _eventRelativeTime=false;
+  const CRYData *data=_setup->getData(int(_setup->param(CRYSetup::altitude)+0.1));
 
   if ( data == 0 ) {
     std::cerr << "CRY::CRYGenerator: Data table not available for ";
@@ -158,17 +159,25 @@ CRYGenerator::CRYGenerator(CRYSetup *setup) {
     std::string cosThetaKey=name; cosThetaKey.append("CosThetaDist");
     std::string chargeKey=name; chargeKey.append("ChargeDist");
 
-    CRYPdf *tPdf=data->getPdf(latKey);
+    const CRYPdf *tPdf=data->getPdf(latKey);
     if ( tPdf == 0 ) {
       _latPdfs[i]=data->getPdf(latDistDef);
     }
     else
       _latPdfs[i]=tPdf;
 
-    //horrible hack - set the latpdf min and max to the box size by hand
+    //horrible hack - set the latpdf min and max to the box size by hand.
+    //The data tables are shared with other setups at this altitude, so
+    //this is done on a copy owned by the generator
     if ( _latPdfs[i] != 0 ) {
-      _latPdfs[i]->setMin(-1.0*_boxSize/2.0);
-      _latPdfs[i]->setMax(_boxSize/2.0);
+      const CRYPdf *shared=_latPdfs[i];
+      if ( _boxLatPdfs.find(shared) == _boxLatPdfs.end() ) {
+	_boxLatPdfs[shared]=new CRYPdf(shared->name(),shared->key(),shared->type(),
+				       -1.0*_boxSize/2.0,_boxSize/2.0,
+				       new std::vector<std::vector<double> >(*shared->params()),
+				       new std::vector<std::vector<double> >(*shared->cdfs()));
+      }
+      _latPdfs[i]=_boxLatPdfs[shared];
     }
 
     tPdf=data->getPdf(timeKey);
@@ -261,6 +270,12 @@ CRYGenerator::CRYGenerator(CRYSetup *setup) {
   _primaryPart=0;
 }
 
+CRYGenerator::~CRYGenerator() {
+  std::map<const CRYPdf*, CRYPdf*>::iterator iter;
+  for ( iter=_boxLatPdfs.begin(); iter != _boxLatPdfs.end(); iter++ )
+    delete iter->second;
+}
+
 std::vector<CRYParticle*>* CRYGenerator::genEvent() {
   std::vector <CRYParticle*>* retList=0;
   genEvent(retList);
@@ -271,6 +286,7 @@ void CRYGenerator::genEvent(std::vector<CRYParticle*> *retList) {
   if ( retList==0 ) retList=new std::vector<CRYParticle*>;
 
   int pBin=0,sBin=0;
+  _primary->startEvent();
 
   do {
     delete _primaryPart;
@@ -309,7 +325,8 @@ void CRYGenerator::genEvent(std::vector<CRYParticle*> *retList) {
 
       //....sample the time distribution
       sBin=_secondaryBinning->bin(keSecondary);
-      double timeSecondary=_primary->timeSimulated() + _timePdfs[idSec]->draw(_utils,sBin);
+      double timePrimary=_eventRelativeTime ? _primary->timeInEvent() : _primary->timeSimulated();
+      double timeSecondary=timePrimary + _timePdfs[idSec]->draw(_utils,sBin);
 
       int charge=(int)_chargePdfs[idSec]->draw(_utils,sBin);
 
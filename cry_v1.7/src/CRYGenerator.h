@@ -67,6 +67,7 @@ class CRYGenerator {
 
 public:
   CRYGenerator(CRYSetup *setup);
+  ~CRYGenerator();
 
   //ways to generate an event
   //a single cosmic shower is returned
@@ -77,6 +78,12 @@ public:
   //Time that has been simulated by this instance
   double timeSimulated() {return _primary->timeSimulated();}
 
+  //Give particle times from the start of their event instead of on the
+  //clock of timeSimulated. Either way the time includes the wait for the
+  //event's primaries, but an event time only depends on that event's
+  //random numbers, not on the events generated before it.
+  void setEventRelativeTime(bool relative) {_eventRelativeTime=relative;}
+
   //Pointer to the primary particle
   //Note that ownership is not transfered
   CRYParticle *primaryParticle() {return _primaryPart;}
@@ -89,16 +96,19 @@ public:
 private:
   CRYPrimary *_primary;
   CRYUtils *_utils;
-  CRYBinning *_primaryBinning,*_secondaryBinning;
-  CRYPdf *_nParticlesPDF;
-  CRYPdf *_particleFractionsPDF;
+  const CRYBinning *_primaryBinning,*_secondaryBinning;
+  const CRYPdf *_nParticlesPDF;
+  const CRYPdf *_particleFractionsPDF;
   std::map<int,CRYParticle::CRYId> _idDict;
-  std::map<CRYParticle::CRYId, CRYPdf*> _kePdfs,_latPdfs;
-  std::map<CRYParticle::CRYId, CRYPdf*> _timePdfs,_cosThetaPdfs,_chargePdfs;
+  std::map<CRYParticle::CRYId, const CRYPdf*> _kePdfs,_latPdfs;
+  // this generator's copies of the lateral pdfs, set to its box size
+  std::map<const CRYPdf*, CRYPdf*> _boxLatPdfs;
+  std::map<CRYParticle::CRYId, const CRYPdf*> _timePdfs,_cosThetaPdfs,_chargePdfs;
   std::map<CRYParticle::CRYId, bool> _tallyList;
   double _boxSize;
   double _subboxSize;
   int _maxParticles,_minParticles;
+  bool _eventRelativeTime;
   CRYSetup *_setup;
   CRYWeightFunc *_primaryWeighting;
   CRYParticle *_primaryPart;
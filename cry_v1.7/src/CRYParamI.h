@@ -67,7 +67,7 @@ public:
   ~CRYParamI() {;}
 
   // get the value
-  int param() {return _param;}
+  int param() const {return _param;}
 
 private:
   int _param;
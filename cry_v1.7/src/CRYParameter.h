@@ -67,7 +67,7 @@ public:
   virtual ~CRYParameter() {;}
 
   // get the value
-  double param() {return _param;}
+  double param() const {return _param;}
 
 private:
 
@@ -155,6 +155,7 @@ CRYPdf::CRYPdf(std::string data) {
     }
   }
 
+  buildGuides();
 }
 
 
@@ -194,6 +195,21 @@ CRYPdf::CRYPdf(std::string name,
     _cdfs->push_back(cdf);
   }
 
+  buildGuides();
+}
+
+CRYPdf::CRYPdf(std::string name, std::string binning,
+	       pdfType pType, double storedMin, double storedMax,
+	       std::vector< std::vector<double> > *params,
+	       std::vector< std::vector<double> > *cdfs) {
+  _name=name;
+  _binningKey=binning;
+  _type=pType;
+  _min=storedMin;
+  _max=storedMax;
+  _params=params;
+  _cdfs=cdfs;
+  buildGuides();
 }
 
 
@@ -248,30 +264,47 @@ void CRYPdf::readSetOfParams(std::string data) {
   _cdfs->push_back(cdf);
 }
 
-double CRYPdf::draw( CRYUtils *utils, int bin ) {
-  double rand=utils->randomFlat();
-  int cdfSize=(*_cdfs)[bin].size();
-
-  int i1=0;
-  int divit=int(sqrt((*_cdfs)[bin].size()));
-  int i1Max=cdfSize/divit;
-  if ( cdfSize % divit == 0 ) i1Max--;
-  for ( i1=1; i1<= i1Max; ) {
-    if ( (*_cdfs)[bin][i1*divit] > rand ) break;
-    i1++;
+// Guide tables (indexed search) for draw. With as many guide entries
+// as cdf values, the search from the guide entry takes about one step,
+// whatever the number of values.
+void CRYPdf::buildGuides() {
+  _guides.clear();
+  for ( unsigned int b=0; b<_cdfs->size(); b++ ) {
+    const std::vector<double> &cdf=(*_cdfs)[b];
+    int cdfSize=cdf.size();
+    int nGuides=std::max(1,cdfSize);
+    std::vector<int> guide(nGuides);
+    int i=0;
+    for ( int k=0; k<nGuides; k++ ) {
+      while ( i<cdfSize && !(cdf[i] > double(k)/nGuides) ) i++;
+      guide[k]=i;
+    }
+    _guides.push_back(guide);
   }
+}
 
-  for (int i=(i1-1)*divit; i<  std::min(1.0+i1*divit,1.0*cdfSize); i++ ) {
-    if ( (*_cdfs)[bin][i] > rand ) { 
-      if ( _type == CRYPdf::DISCRETE ) 
-	return _min + i*( _max-_min)/(std::max(1.0,double(cdfSize)-1));
-      if ( _type == CRYPdf::LINEAR ) 
-	return _min + (i+utils->randomFlat())*( _max-_min)/(cdfSize);
-      if ( _type == CRYPdf::LOG )  
-	return pow(10.,_min + (i+utils->randomFlat())*( _max-_min)/(cdfSize));
-      std::cerr << "CRY::CRYPdf: Unknown pdf type? (impossible...)\n";
-      assert(0);
-    }
+double CRYPdf::draw( CRYUtils *utils, int bin ) const {
+  double rand=utils->randomFlat();
+  const std::vector<double> &cdf=(*_cdfs)[bin];
+  const std::vector<int> &guide=_guides[bin];
+  int cdfSize=cdf.size();
+
+  // Find the first value whose cdf exceeds rand. The guide entry is a
+  // lower bound; step back in case rand*size rounded up to the next one.
+  int k=std::min(int(rand*guide.size()),int(guide.size())-1);
+  int i=guide[k];
+  while ( i>0 && cdf[i-1] > rand ) i--;
+  while ( i<cdfSize && !(cdf[i] > rand) ) i++;
+
+  if ( i<cdfSize ) {
+    if ( _type == CRYPdf::DISCRETE ) 
+      return _min + i*( _max-_min)/(std::max(1.0,double(cdfSize)-1));
+    if ( _type == CRYPdf::LINEAR ) 
+      return _min + (i+utils->randomFlat())*( _max-_min)/(cdfSize);
+    if ( _type == CRYPdf::LOG )  
+      return pow(10.,_min + (i+utils->randomFlat())*( _max-_min)/(cdfSize));
+    std::cerr << "CRY::CRYPdf: Unknown pdf type? (impossible...)\n";
+    assert(0);
   }
 
   // should never get here
@@ -297,7 +330,7 @@ std::string CRYPdf::spaceTrimmer(std::string str, int nskip) {
   return retval;
 }
 
-std::vector<double> CRYPdf::mean() {
+std::vector<double> CRYPdf::mean() const {
 
   std::vector<double> retVal;
   for ( unsigned int i=0; i< _params->size(); i++) {
@@ -326,7 +359,7 @@ std::vector<double> CRYPdf::mean() {
 
 }
 
-std::vector<double> CRYPdf::sum() {
+std::vector<double> CRYPdf::sum() const {
 
   std::vector<double> retVal;
   for ( unsigned int i=0; i< _params->size(); i++) {
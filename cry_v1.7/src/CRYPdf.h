@@ -92,6 +92,16 @@ public:
 	 pdfType pType,
 	 std::string binning,
 	 std::vector< std::vector<double> > values);
+
+  // Constructor from already computed tables (the binary cache of
+  // CRYData, or copies of another pdf). Takes the limits as stored
+  // (log10 of the values for LOG pdfs) and the cdfs as computed when
+  // the text was read, so the pdf is identical to the text one.
+  // Takes ownership of params and cdfs.
+  CRYPdf(std::string name, std::string binning,
+	 pdfType pType, double storedMin, double storedMax,
+	 std::vector< std::vector<double> > *params,
+	 std::vector< std::vector<double> > *cdfs);
 	 
   //Nominal destructor
   ~CRYPdf() {delete _params; delete _cdfs;}
@@ -101,24 +111,33 @@ public:
   void print(std::ostream& o, bool printData=false);
 
   // Function key
-  std::string name() {return _name;}
+  std::string name() const {return _name;}
 
   //Return binning key for this pdf (key for CRYBinning object)
-  std::string key() {return _binningKey;}
+  std::string key() const {return _binningKey;}
 
   //Direct access to PDF values
-  const std::vector<std::vector<double> >* params() {return _params;}
+  const std::vector<std::vector<double> >* params() const {return _params;}
+
+  //Direct access to the normalized cumulative distributions
+  const std::vector<std::vector<double> >* cdfs() const {return _cdfs;}
+
+  //Type and limits as stored (log10 of the limits for LOG pdfs)
+  pdfType type() const {return _type;}
+  double storedMin() const {return _min;}
+  double storedMax() const {return _max;}
 
   //Given primary binning, draw random value from PDF
-  double draw(CRYUtils *utils, int bin);
+  //Takes constant time on average (see buildGuides)
+  double draw(CRYUtils *utils, int bin) const;
 
   //Compute mean of PDF. Value is returned for each bin in primary
   //binning if PDF definition has two dimensions
-  std::vector<double> mean();
+  std::vector<double> mean() const;
 
   //Compute sum of PDF. Value is returned for each bin in primary
   //binning if PDF definition has two dimensions
-  std::vector<double> sum();
+  std::vector<double> sum() const;
 
   //hack - add accessors to set min and max..
   void setMin(double min) {_min=min;}
@@ -127,6 +146,7 @@ public:
 
 private:
   void readSetOfParams(std::string data);
+  void buildGuides();
   std::string spaceTrimmer(std::string str, int nskip=0);
 
 
@@ -139,6 +159,10 @@ private:
   std::vector<std::vector<double > > *_params;
   std::vector<std::vector<double > > *_cdfs; // normalized to 1
 
+  // Guide tables for draw, one per bin: with n cdf values, entry k
+  // is the first index whose cdf exceeds k/n
+  std::vector<std::vector<int> > _guides;
+
 };
 
 #endif
@@ -61,10 +61,11 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <math.h>
 #include <iostream>
 
-CRYPrimary::CRYPrimary(CRYUtils *utils, CRYData *data, 
+CRYPrimary::CRYPrimary(CRYUtils *utils, const CRYData *data, 
 		       double date, double latitude) {
 
   _dt=0.;
+  _eventDt=0.;
   _utils=utils;
   _solarMin= data->getFunction("primarySpectrumSolarMin");
   _solarMax= data->getFunction("primarySpectrumSolarMax");   
@@ -93,7 +94,7 @@ CRYPrimary::CRYPrimary(CRYUtils *utils, CRYData *data,
   _minEnergy=_binning->min();
   _maxEnergy=_binning->max();
 
-  CRYAbsFunction *cutoffMaker = data->getFunction("bfieldCorr");
+  const CRYAbsFunction *cutoffMaker = data->getFunction("bfieldCorr");
   _minEnergy=std::max(_minEnergy,cutoffMaker->value(latitude));
 
   _cachedPdf=0;
@@ -109,7 +110,9 @@ CRYParticle* CRYPrimary::getPrimary() {
   double kine=0.;
 
   kine=_cachedPdf->draw(_utils,0);
-  _dt+=-_lifeTime*log(_utils->randomFlat());
+  double wait=-_lifeTime*log(_utils->randomFlat());
+  _dt+=wait;
+  _eventDt+=wait;
   return new CRYParticle(CRYParticle::Proton,0, kine);
 }
 
@@ -69,7 +69,7 @@ public:
   // data is the data table
   // date is in years to approximate the solar cycle
   // latitude is in degrees!
-  CRYPrimary(CRYUtils *utils, CRYData *data, 
+  CRYPrimary(CRYUtils *utils, const CRYData *data, 
 	     double date=2007, double latitude=0);
 
   ~CRYPrimary() {;}
@@ -90,6 +90,10 @@ public:
   //The time elapsed during the simulation of primaries 
   double timeSimulated() {return _dt;}
 
+  //The time elapsed since the last call to startEvent
+  void startEvent() {_eventDt=0.;}
+  double timeInEvent() {return _eventDt;}
+
   // Sum of unweighted partial rates
   double totalRate();
 
@@ -97,17 +101,17 @@ private:
 
   // primary spectrum is a weighted sum of solar min and solar
   // max parmaeters
-  CRYAbsFunction *_solarMin;
-  CRYAbsFunction *_solarMax;
-  CRYParameter* _solarCycleStart;
-  CRYParameter* _solarCycleLength;
+  const CRYAbsFunction *_solarMin;
+  const CRYAbsFunction *_solarMax;
+  const CRYParameter* _solarCycleStart;
+  const CRYParameter* _solarCycleLength;
   double _cycle;
 
   CRYUtils *_utils; //random numbers
 
   //Energy boundaries
   double _minEnergy,_maxEnergy;
-  CRYBinning *_binning;
+  const CRYBinning *_binning;
 
   //Optional weighting function
   CRYWeightFunc *_wf;
@@ -115,8 +119,9 @@ private:
   //Computed lifetime
   double _lifeTime;
 
-  //Time simulated
+  //Time simulated, in total and in the current event
   double _dt;
+  double _eventDt;
 
   //Store the maximum of PDF for comparison with randoms
   double _maxPDF;
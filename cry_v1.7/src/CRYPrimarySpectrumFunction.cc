@@ -49,7 +49,7 @@ CRYPrimarySpectrumFunction::CRYPrimarySpectrumFunction(std::string name, std::st
 
   // Evaluate the function given an input or vector of inputs
   // These are defined in the derived classes
-double CRYPrimarySpectrumFunction::value(double x) {
+double CRYPrimarySpectrumFunction::value(double x) const {
   return  (*_params)[0] * pow( x+(*_params)[1],(*_params)[2])*
            pow(x,(*_params)[3]);
 }
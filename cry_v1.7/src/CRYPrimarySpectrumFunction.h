@@ -68,8 +68,8 @@ public:
 
   // Evaluate the function given an input or vector of inputs
   // These are defined in the derived classes
-  double value(double x);
-  double value(std::vector<double> x) {return value(x[0]);}
+  double value(double x) const;
+  double value(std::vector<double> x) const {return value(x[0]);}
 
 private:
 
@@ -43,27 +43,22 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "CRYData.h"
 #include <sstream>
 #include <iostream>
+#include <fstream>
+#include <mutex>
 #include <assert.h>
 #include <stdlib.h>  // For Ubuntu Linux
 
+namespace {
+  // Data tables read so far, by file name, for all CRYSetup objects
+  // (and threads) of the process. Like before, they are never deleted.
+  std::mutex loadedDataMutex;
+  std::map<std::string, CRYData*> loadedData;
+}
+
 CRYSetup::CRYSetup(std::string configData, std::string dataDir) {
 
   _utils=new CRYUtils;
-
-  //read the data!
-  int nAlt=3;
-  int altitudes[3];
-  altitudes[0]=0;
-  altitudes[1]=2100;
-  altitudes[2]=11300;
-
-  for (int i=0; i < nAlt; i++) {
-    std::ostringstream fileName;
-    fileName << dataDir << "/cosmics_" << altitudes[i] << ".data";
-    CRYData *data=new CRYData(fileName.str());
-    _data[altitudes[i]]=data;
-  }
-  //data->print(std::cout);
+  _dataDir=dataDir;
 
 
   //param names
@@ -223,6 +218,27 @@ double CRYSetup::parseDate(std::string date) {
   return year + (static_cast <double>(nbr_days) / nbr_days_in_year);
 }
 
+//
+//.... Return the data table of an altitude, reading it on first use
+//
+const CRYData *CRYSetup::getData(int altitude) {
+  std::ostringstream fileName;
+  fileName << _dataDir << "/cosmics_" << altitude << ".data";
+
+  std::lock_guard<std::mutex> lock(loadedDataMutex);
+  std::map<std::string, CRYData*>::iterator iter=loadedData.find(fileName.str());
+  if ( iter != loadedData.end() ) return iter->second;
+
+  // CRYData stops on a missing file, so check for the text or its cache
+  std::ifstream text(fileName.str().c_str());
+  std::ifstream cache(CRYData::cacheFile(fileName.str()).c_str());
+  if ( !text.is_open() && !cache.is_open() ) return 0;
+
+  CRYData *data=new CRYData(fileName.str());
+  loadedData[fileName.str()]=data;
+  return data;
+}
+
 //
 //.... Determine if a year is a leap year
 //
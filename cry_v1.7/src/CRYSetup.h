@@ -85,18 +85,24 @@ public:
   //  <key> <value>
   // separated by whitespace
   // Keys are defined in constructor of CRYSetup
+  // No data table is read here; see getData
   CRYSetup(std::string configData, std::string dataDir="./");
 
-  //Nothing to delete
-  ~CRYSetup() {}
+  //The data tables are shared and kept for the process
+  ~CRYSetup() {delete _utils;}
 
   //Get value of parameter
   double param(CRYSetup::CRYParms parm) {return _parms[parm];}
   void setParam(CRYSetup::CRYParms parm, double value) { _parms[parm]=value;}
 
-  void setRandomFunction(double (*newFunc)(void)) {_utils->setRandomFunction(newFunc);}
+  // Random source of this setup's generators (see CRYUtils)
+  void setRandomFunction(std::function<double()> newFunc) {_utils->setRandomFunction(newFunc);}
 
-  CRYData *getData(int altitude=0) {return _data[altitude];}
+  // Data table of an altitude (dataDir/cosmics_<altitude>.data), read
+  // on first use. Tables are kept for the whole process and shared by
+  // every CRYSetup using the same file, so they must not be modified.
+  // Returns 0 if there is no table for this altitude.
+  const CRYData *getData(int altitude=0);
   CRYUtils *getUtils() {return _utils;}
 
 private:
@@ -106,7 +112,7 @@ private:
   std::map<CRYSetup::CRYParms,std::string> _parmNames;
 
   CRYUtils *_utils;
-  std::map<int, CRYData* > _data;
+  std::string _dataDir;
 
   double parseDate(std::string date); //....convert date string to decimal year
   bool isLeapYear(int yr); // Returns true if yr is a leap year, false if not
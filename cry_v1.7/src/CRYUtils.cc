@@ -43,8 +43,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <iostream>
 
 CRYUtils::CRYUtils() {
-  rngdptr=0;
-  setRandomFunction(tmpRandom);
+  _next=1;
 }
 
 std::string CRYUtils::removeTrailingSpaces(std::string input) {
@@ -60,9 +59,18 @@ std::string CRYUtils::removeTrailingSpaces(std::string input) {
 
 // until we get one from the transport coders
 double CRYUtils::randomFlat(double min, double max) {
-  return min+ (max-min)*((double)rngdptr());
+  return min+ (max-min)*(_rng ? _rng() : defaultRandom());
 }
 
+// Same sequence as tmpRandom, but with per-instance state
+double CRYUtils::defaultRandom() {
+  _next=_next*1103515245+123345;
+  unsigned temp=(unsigned)(_next/65536) % 32768;
+
+  return ( temp + 1.0 ) / 32769.0;
+}
+
+// Shared state: not for use from several threads
 double CRYUtils::tmpRandom() {
   static unsigned long int next = 1;
  
@@ -52,6 +52,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define CRYUtils_h
 
 #include "CRYParticle.h"
+#include <functional>
 #include <string>
 
 class CRYUtils {
@@ -65,16 +66,22 @@ public:
   static std::string removeTrailingSpaces(std::string input);
 
   // Interface to random number generator
-  // (use of external random number generators not yet implmented
+  // The random source belongs to this instance: any callable returning
+  // a flat number in (0,1), e.g. a lambda bound to a thread's own engine.
+  // Without one, a simple generator private to the instance is used, so
+  // instances on different threads never share random number state.
   double randomFlat(double min=0., double max=1.);
   static double tmpRandom();
-  void setRandomFunction(double (*newFunc)(void)) { rngdptr=newFunc;}
+  void setRandomFunction(std::function<double()> newFunc) { _rng=newFunc;}
 
   //Keys for particle types -- enums defined in CRYParticle class
   static std::string partName(CRYParticle::CRYId id);
 
 private:
-  double (*rngdptr)(void);
+  double defaultRandom();
+
+  std::function<double()> _rng;
+  unsigned long int _next; // state of the default generator
 
 };
 
@@ -44,7 +44,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <assert.h>
 #include <iostream>
 
-CRYWeightFunc::CRYWeightFunc(CRYBinning *bins, std::vector<double> weights) {
+CRYWeightFunc::CRYWeightFunc(const CRYBinning *bins, std::vector<double> weights) {
 
   _bins=bins;
   _weights=new std::vector<double>(weights);
@@ -62,11 +62,11 @@ CRYWeightFunc::CRYWeightFunc(CRYBinning *bins, std::vector<double> weights) {
   }
 }
 
-double CRYWeightFunc::weight(double value) {
+double CRYWeightFunc::weight(double value) const {
   int b=_bins->bin(value);
   return (*_weights)[b];
 }
 
-double CRYWeightFunc::weightBin(unsigned int b) {
+double CRYWeightFunc::weightBin(unsigned int b) const {
   return (*_weights)[b];
 }
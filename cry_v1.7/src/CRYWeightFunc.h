@@ -59,21 +59,21 @@ class CRYWeightFunc {
 public:
 
   // Constructor requires a set of bins and a list of weights
-  CRYWeightFunc(CRYBinning *bins, std::vector<double> weights);
+  CRYWeightFunc(const CRYBinning *bins, std::vector<double> weights);
 
   ~CRYWeightFunc() { delete _weights;}
 
   // given an input, compute the weight
-  double weight(double value);
+  double weight(double value) const;
 
   // Direct access to the binning
-  const CRYBinning *bins() {return _bins;}
+  const CRYBinning *bins() const {return _bins;}
 
   // Given a bin # (0..N-1) determine the weight
-  double weightBin(unsigned int b);
+  double weightBin(unsigned int b) const;
 
 private:
-  CRYBinning *_bins;
+  const CRYBinning *_bins;
   std::vector<double> *_weights;
 };
 
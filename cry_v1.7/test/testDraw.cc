@@ -0,0 +1,139 @@
+//
+//  testDraw.cc
+//
+//  Micro-benchmark of CRYPdf::draw. For every pdf of a data file, draws
+//  from all of its bins with the guide-table search of CRYPdf::draw and
+//  with the two-level sqrt(n) block scan it replaced, and reports the
+//  draws per second of both. The two use the same random sequence and
+//  must return the same values. Bins without any entries (all zero,
+//  never drawn by the generator) are skipped.
+//
+
+#include "CRYData.h"
+#include "CRYPdf.h"
+#include "CRYUtils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <math.h>
+#include <stdlib.h>
+
+namespace {
+
+  // CRYPdf::draw as it was before the guide tables
+  double scanDraw(const CRYPdf *pdf, CRYUtils *utils, int bin) {
+    const std::vector<double> &cdf=(*pdf->cdfs())[bin];
+    double min=pdf->storedMin();
+    double max=pdf->storedMax();
+    double rand=utils->randomFlat();
+    int cdfSize=cdf.size();
+
+    int i1=0;
+    int divit=int(sqrt(cdf.size()));
+    int i1Max=cdfSize/divit;
+    if ( cdfSize % divit == 0 ) i1Max--;
+    for ( i1=1; i1<= i1Max; ) {
+      if ( cdf[i1*divit] > rand ) break;
+      i1++;
+    }
+
+    for (int i=(i1-1)*divit; i<  std::min(1.0+i1*divit,1.0*cdfSize); i++ ) {
+      if ( cdf[i] > rand ) {
+        if ( pdf->type() == CRYPdf::DISCRETE )
+          return min + i*( max-min)/(std::max(1.0,double(cdfSize)-1));
+        if ( pdf->type() == CRYPdf::LINEAR )
+          return min + (i+utils->randomFlat())*( max-min)/(cdfSize);
+        return pow(10.,min + (i+utils->randomFlat())*( max-min)/(cdfSize));
+      }
+    }
+    return 0.0;
+  }
+
+  double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+  }
+
+}
+
+int main( int argc, const char *argv[]) {
+
+  std::string dataFile="./data/cosmics_0.data";
+  int nDraws=200000; //....per pdf bin
+
+  if ( argc > 1 ) dataFile=argv[1];
+  if ( argc > 2 ) nDraws=atoi(argv[2]);
+
+  CRYData data(dataFile);
+  std::vector<std::string> names=data.getPdfList("");
+
+  std::cout << std::left << std::setw(28) << "pdf" << std::right
+            << std::setw(6) << "bins" << std::setw(8) << "values"
+            << std::setw(14) << "scan draws/s" << std::setw(15) << "guide draws/s"
+            << std::setw(9) << "speedup" << "\n";
+
+  double scanTotal=0.;
+  double guideTotal=0.;
+  long long nTotal=0;
+  int nDifferent=0;
+
+  for ( unsigned n=0; n<names.size(); n++ ) {
+    const CRYPdf *pdf=data.getPdf(names[n]);
+    std::vector<int> bins;
+    unsigned nValues=0;
+    for ( unsigned b=0; b<pdf->cdfs()->size(); b++ ) {
+      const std::vector<double> &cdf=(*pdf->cdfs())[b];
+      if ( cdf.empty() || !(cdf.back() > 0.) ) continue;
+      bins.push_back(b);
+      nValues=std::max(nValues,(unsigned)cdf.size());
+    }
+    int nBins=bins.size();
+    if ( nBins == 0 ) continue;
+
+    CRYUtils scanUtils;
+    CRYUtils guideUtils;
+    std::vector<double> scanValues(nDraws);
+    std::vector<double> guideValues(nDraws);
+    double scanTime=0.;
+    double guideTime=0.;
+
+    for ( int j=0; j<nBins; j++ ) {
+      int b=bins[j];
+      std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+      for ( int i=0; i<nDraws; i++ ) scanValues[i]=scanDraw(pdf,&scanUtils,b);
+      scanTime+=seconds(start);
+
+      start=std::chrono::steady_clock::now();
+      for ( int i=0; i<nDraws; i++ ) guideValues[i]=pdf->draw(&guideUtils,b);
+      guideTime+=seconds(start);
+
+      if ( scanValues != guideValues ) nDifferent++;
+    }
+
+    long long nPdf=(long long)nBins*nDraws;
+    scanTotal+=scanTime;
+    guideTotal+=guideTime;
+    nTotal+=nPdf;
+    std::cout << std::left << std::setw(28) << names[n] << std::right
+              << std::setw(6) << nBins << std::setw(8) << nValues
+              << std::setw(14) << std::setprecision(3) << nPdf/scanTime
+              << std::setw(15) << nPdf/guideTime
+              << std::setw(9) << std::fixed << std::setprecision(2) << scanTime/guideTime
+              << std::defaultfloat << "\n";
+  }
+
+  std::cout << "Total: " << nTotal << " draws, scan " << std::setprecision(3)
+            << nTotal/scanTotal << " draws/s, guide " << nTotal/guideTotal
+            << " draws/s, speedup " << std::fixed << std::setprecision(2)
+            << scanTotal/guideTotal << "\n";
+
+  if ( nDifferent != 0 ) {
+    std::cout << nDifferent << " pdf bins drew different values\n";
+    return 1;
+  }
+  std::cout << "All draws identical\n";
+  return 0;
+}
@@ -0,0 +1,137 @@
+//
+//  testThreads.cc
+//
+//  Generates the same events on one thread and on several threads and
+//  checks that every event comes out identical.
+//
+//  Each thread has its own CRYSetup and CRYGenerator, sharing the data
+//  tables, and its own random engine bound through setRandomFunction.
+//  As in a Geant4 run, the engine is reseeded for every event from a
+//  list of seeds drawn from one master seed, so an event only depends on
+//  its seed, not on the thread that generates it.
+//
+//  The generators give event-relative particle times, as the Geant4
+//  application does: CRY's own clock adds up the time of all events a
+//  generator has produced, so it depends on which thread ran which.
+//  Everything, times included, is compared to the last bit.
+//
+
+#include "CRYGenerator.h"
+#include "CRYSetup.h"
+
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fstream>
+#include <stdlib.h>
+
+namespace {
+
+  double flat(std::mt19937_64 &engine) {
+    // 53 random bits, strictly inside (0,1)
+    return ((engine() >> 11) + 0.5) / 9007199254740992.;
+  }
+
+  // Generate events first, first+nThreads, ... into output
+  void generate(const std::string &setupString, const std::vector<unsigned long long> &seeds,
+                int first, int nThreads, std::vector<std::string> &output) {
+
+    std::mt19937_64 engine;
+    CRYSetup setup(setupString,"./data");
+    setup.setRandomFunction([&engine]() { return flat(engine); });
+    CRYGenerator gen(&setup);
+    gen.setEventRelativeTime(true);
+
+    std::vector<CRYParticle*> ev;
+    for ( unsigned i=first; i<seeds.size(); i+=nThreads ) {
+      engine.seed(seeds[i]);
+      ev.clear();
+      gen.genEvent(&ev);
+
+      std::ostringstream out;
+      out << std::setprecision(17);
+      for ( unsigned j=0; j<ev.size(); j++ ) {
+        CRYParticle *p=ev[j];
+        out << CRYUtils::partName(p->id())
+            << " " << p->ke()
+            << " " << p->x() << " " << p->y() << " " << p->z()
+            << " " << p->u() << " " << p->v() << " " << p->w()
+            << " " << p->t() << "\n";
+        delete p;
+      }
+      output[i]=out.str();
+    }
+  }
+
+  std::vector<std::string> run(const std::string &setupString,
+                               const std::vector<unsigned long long> &seeds, int nThreads) {
+    std::vector<std::string> output(seeds.size());
+    std::vector<std::thread> threads;
+    for ( int t=0; t<nThreads; t++ )
+      threads.push_back(std::thread(generate,std::cref(setupString),std::cref(seeds),
+                                    t,nThreads,std::ref(output)));
+    for ( unsigned t=0; t<threads.size(); t++ ) threads[t].join();
+    return output;
+  }
+
+}
+
+int main( int argc, const char *argv[]) {
+
+  int nEv=1000;
+  int nThreads=4;
+
+  if ( argc < 2 ) {
+    std::cout << "usage " << argv[0] << " <setup file name> <N events> <N threads>\n";
+    std::cout << "N events = " << nEv << ", N threads = " << nThreads << " by default\n";
+    return 0;
+  }
+
+  if ( argc > 2 ) nEv=atoi(argv[2]);
+  if ( argc > 3 ) nThreads=atoi(argv[3]);
+
+  // Read the setup file into setupString
+  std::ifstream inputFile;
+  inputFile.open(argv[1],std::ios::in);
+  char buffer[1000];
+
+  std::string setupString("");
+  while ( !inputFile.getline(buffer,1000).eof()) {
+    setupString.append(buffer);
+    setupString.append(" ");
+  }
+
+  // Per-event seeds from a fixed master seed
+  std::mt19937_64 master(12345);
+  std::vector<unsigned long long> seeds(nEv);
+  for ( int i=0; i<nEv; i++ ) seeds[i]=master();
+
+  std::vector<std::string> single=run(setupString,seeds,1);
+  std::vector<std::string> multi=run(setupString,seeds,nThreads);
+
+  int nParticles=0;
+  int nDifferent=0;
+  for ( int i=0; i<nEv; i++ ) {
+    for ( unsigned j=0; j<single[i].size(); j++ )
+      if ( single[i][j] == '\n' ) nParticles++;
+    if ( single[i] != multi[i] ) {
+      if ( nDifferent == 0 )
+        std::cout << "Event " << i << " differs:\n"
+                  << "1 thread:\n" << single[i]
+                  << nThreads << " threads:\n" << multi[i];
+      nDifferent++;
+    }
+  }
+
+  std::cout << "Events: " << nEv << " particles: " << nParticles << "\n";
+  if ( nDifferent != 0 ) {
+    std::cout << nDifferent << " events differ between 1 and " << nThreads << " threads\n";
+    return 1;
+  }
+  std::cout << "All events identical on 1 and " << nThreads << " threads\n";
+  return 0;
+}
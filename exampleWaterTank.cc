@@ -12,8 +12,8 @@
 #include "G4VisExecutive.hh"
 #include "G4OpticalPhysics.hh"
 #include "G4OpticalParameters.hh"
+#include "G4FastSimulationPhysics.hh"
 #include <iostream>
-#include "G4AnalysisManager.hh"
 
 /// Entry point that configures the Geant4 run manager, physics list, and
 // visualization stack before either running in batch mode or opening an
@@ -33,10 +33,6 @@ int main(int argc,char** argv)
   G4int precision = 4;
   G4SteppingVerbose::UseBestUnit(precision);
 
-  // Ensure that individual worker threads merge their ntuples before writing
-  // to disk. This keeps output in a single ROOT file even in MT mode.
-  G4AnalysisManager::Instance()->SetNtupleMerging(true);
-
   // Construct the default run manager which owns the detector geometry and
   // orchestrates event processing.
   auto runManager = G4RunManagerFactory::CreateRunManager(G4RunManagerType::Default);
@@ -66,6 +62,14 @@ int main(int argc,char** argv)
   // Values ~0.05-0.1 are realistic; 10.0 was far too coarse and under-sampled yield.
   opticalParameters->SetCerenkovMaxBetaChange(0.05);
 
+  // Enable fast simulation for muons so the water-region Cherenkov model can
+  // take over when /watertank/optics/mode fast is selected. The model does
+  // not trigger in the default full mode.
+  auto fastSimulationPhysics = new G4FastSimulationPhysics();
+  fastSimulationPhysics->ActivateFastSimulation("mu-");
+  fastSimulationPhysics->ActivateFastSimulation("mu+");
+  physicsList->RegisterPhysics(fastSimulationPhysics);
+
   runManager->SetUserInitialization(physicsList);
     
   // Register all user actions (primary generator, run/event/stepping hooks).
@@ -19,33 +19,22 @@
 
 class G4Event;
 
-/// Template class for random number generator wrapper
-template<class T>
-class RNGWrapper { 
-  public:
-    static void set(T* object, double (T::*func)(void));
-    static double rng(void);
-  private:
-    static T* m_obj;
-    static double (T::*m_func)(void);
-};
-
-template<class T> T* RNGWrapper<T>::m_obj;
-template<class T> double (T::*RNGWrapper<T>::m_func)(void);
-
-template<class T> void RNGWrapper<T>::set(T* object, double (T::*func)(void)) {
-  m_obj = object; m_func = func;
-}
-
-template<class T> double RNGWrapper<T>::rng(void) { 
-  return (m_obj->*m_func)(); 
-}
-
 /// Primary generator using CRY cosmic ray shower library
 ///
 /// This class interfaces with the CRY library to generate realistic 
 /// cosmic ray showers. It provides a configurable interface for
 /// cosmic ray simulation with geographic and temporal flexibility.
+///
+/// Each worker thread has its own instance, which owns only its CRY setup
+/// and generator state (primary timing, box-sized lateral pdf, particle
+/// buffer). The CRY data tables are read once per process and shared
+/// read-only by all instances (see CRYSetup::getData). CRY draws its random
+/// numbers from the engine of the thread that set it up, through a callable
+/// held by the instance's own CRY setup, so workers neither share nor race
+/// on random number state and events follow Geant4's per-event seeding.
+/// Particle times are taken from the start of their event, not from CRY's
+/// running clock, so an event, times included, does not depend on the
+/// thread that generates it.
 
 class WaterTankCRYPrimaryGenerator : public G4VPrimaryGenerator
 {
@@ -66,6 +55,7 @@ class WaterTankCRYPrimaryGenerator : public G4VPrimaryGenerator
   private:
     G4ParticleGun* fParticleGun;
     G4ParticleTable* fParticleTable;
+    CRYSetup* fCRYSetup;
     CRYGenerator* fCRYGenerator;
     std::vector<CRYParticle*>* fParticleVector;
     G4bool fInitialized;
@@ -0,0 +1,20 @@
+/// \file WaterTankCherenkov.hh
+/// \brief Constants shared by the Cherenkov light generators
+
+#ifndef WaterTankCherenkov_h
+#define WaterTankCherenkov_h 1
+
+#include "G4SystemOfUnits.hh"
+#include "globals.hh"
+
+/// Constants of the Frank-Tamm yield, shared by the table lookup in the
+/// stepping action and the fast muon model so both produce the light
+/// G4Cerenkov would.
+namespace WaterTankCherenkov
+{
+  /// Yield constant alpha/(hbar c), as used by G4Cerenkov: photons per unit
+  /// path length and photon energy for unit charge and sin^2(theta) = 1.
+  const G4double kYield = 369.81 / (eV * cm);
+}
+
+#endif
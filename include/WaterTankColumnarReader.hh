@@ -0,0 +1,256 @@
+/// \file WaterTankColumnarReader.hh
+/// \brief Columnar output format and its memory-mapped reader
+
+#ifndef WaterTankColumnarReader_h
+#define WaterTankColumnarReader_h 1
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// Layout of the columnar output files (.wtc) written by
+/// WaterTankColumnarWriter, and a reader for them.
+///
+/// A file holds the same tables and columns as the ntuples ("event",
+/// "domhits", "domdigi"). All numbers are little-endian:
+///
+///     Header  := "WTCOLUMN" | u32 version | u32 0
+///     Block*  := the values of one column for one chunk of rows, starting
+///                on an 8-byte boundary
+///     Footer  := u32 nTables, then per table:
+///                  str name | str title | u32 nColumns
+///                  nColumns x (str name | u8 type | u8 isVector | u16 0)
+///                  u64 nRows | u64 nChunks
+///                  nChunks x (u64 firstRow | u32 nRows | u32 0
+///                             | nColumns x (u64 offset | u64 bytes | u64 nValues))
+///     Trailer := u64 footer offset | "WTCOLEND"
+///
+/// with str := u32 length | bytes. Scalar columns store nRows values of
+/// their type ('I' int32, 'F' float32, 'D' float64). Vector columns store
+/// nRows u32 lengths, padding to 8 bytes, then the nValues concatenated
+/// elements. The writer appends blocks while the run goes on and writes the
+/// footer index on close; a file without a trailer was not closed.
+///
+/// The header only depends on the standard library and POSIX so that ROOT
+/// macros (see convert_columnar.C) can include it. The reader maps the file
+/// and returns pointers into the mapping, so columns are read without copies.
+namespace WaterTankColumnar
+{
+  const char kMagic[8] = {'W', 'T', 'C', 'O', 'L', 'U', 'M', 'N'};
+  const char kEndMagic[8] = {'W', 'T', 'C', 'O', 'L', 'E', 'N', 'D'};
+  const std::uint32_t kVersion = 1;
+
+  enum ColumnType : std::uint8_t { kInt = 'I', kFloat = 'F', kDouble = 'D' };
+
+  inline std::size_t TypeSize(std::uint8_t type)
+  {
+    return type == kDouble ? 8 : 4;
+  }
+
+  /// Offset of the values of a vector block holding `rows` lengths.
+  inline std::size_t VectorValuesOffset(std::size_t rows)
+  {
+    return (rows * sizeof(std::uint32_t) + 7) & ~std::size_t(7);
+  }
+
+  inline bool IsLittleEndianHost()
+  {
+    const std::uint32_t one = 1;
+    unsigned char first;
+    std::memcpy(&first, &one, 1);
+    return first == 1;
+  }
+}
+
+class WaterTankColumnarReader
+{
+  public:
+    struct Column
+    {
+      std::string name;
+      std::uint8_t type = WaterTankColumnar::kFloat;
+      bool isVector = false;
+    };
+    struct Block
+    {
+      std::uint64_t offset = 0;
+      std::uint64_t bytes = 0;
+      std::uint64_t nValues = 0;
+    };
+    struct Chunk
+    {
+      std::uint64_t firstRow = 0;
+      std::uint32_t nRows = 0;
+      /// One block per column.
+      std::vector<Block> blocks;
+    };
+    struct Table
+    {
+      std::string name;
+      std::string title;
+      std::vector<Column> columns;
+      std::uint64_t nRows = 0;
+      std::vector<Chunk> chunks;
+    };
+
+    WaterTankColumnarReader() = default;
+    WaterTankColumnarReader(const WaterTankColumnarReader&) = delete;
+    WaterTankColumnarReader& operator=(const WaterTankColumnarReader&) = delete;
+    ~WaterTankColumnarReader() { Close(); }
+
+    /// Map `path` and read its footer. Returns false and sets GetError() if
+    /// the file cannot be mapped or is not a complete columnar file.
+    bool Open(const std::string& path)
+    {
+      Close();
+      if (!WaterTankColumnar::IsLittleEndianHost()) return Fail("big-endian hosts are not supported");
+      const int fd = ::open(path.c_str(), O_RDONLY);
+      if (fd < 0) return Fail("cannot open " + path);
+      struct stat status;
+      if (::fstat(fd, &status) != 0 || status.st_size < 40) {
+        ::close(fd);
+        return Fail(path + " is too short to be a columnar file");
+      }
+      fSize = std::size_t(status.st_size);
+      void* mapping = ::mmap(nullptr, fSize, PROT_READ, MAP_PRIVATE, fd, 0);
+      ::close(fd);
+      if (mapping == MAP_FAILED) {
+        fSize = 0;
+        return Fail("cannot map " + path);
+      }
+      fData = static_cast<const char*>(mapping);
+
+      if (std::memcmp(fData, WaterTankColumnar::kMagic, 8) != 0) return Fail(path + " is not a columnar file");
+      if (Read<std::uint32_t>(8) != WaterTankColumnar::kVersion) return Fail(path + " has an unknown version");
+      if (std::memcmp(fData + fSize - 8, WaterTankColumnar::kEndMagic, 8) != 0) {
+        return Fail(path + " has no footer (was the run interrupted?)");
+      }
+      std::size_t position = Read<std::uint64_t>(fSize - 16);
+      if (!ReadFooter(position)) return Fail(path + " has a corrupt footer");
+      return true;
+    }
+
+    void Close()
+    {
+      if (fData) ::munmap(const_cast<char*>(fData), fSize);
+      fData = nullptr;
+      fSize = 0;
+      fTables.clear();
+    }
+
+    const std::string& GetError() const { return fError; }
+    const std::vector<Table>& GetTables() const { return fTables; }
+
+    /// Index of the named table or column, or -1.
+    int FindTable(const std::string& name) const
+    {
+      for (std::size_t i = 0; i < fTables.size(); ++i) {
+        if (fTables[i].name == name) return int(i);
+      }
+      return -1;
+    }
+    int FindColumn(const Table& table, const std::string& name) const
+    {
+      for (std::size_t i = 0; i < table.columns.size(); ++i) {
+        if (table.columns[i].name == name) return int(i);
+      }
+      return -1;
+    }
+
+    /// Values of a block: nRows values of a scalar column, or the nValues
+    /// concatenated elements of a vector column. T must match the column type.
+    template <typename T>
+    const T* Values(const Column& column, const Chunk& chunk, const Block& block) const
+    {
+      std::size_t offset = block.offset;
+      if (column.isVector) offset += WaterTankColumnar::VectorValuesOffset(chunk.nRows);
+      return reinterpret_cast<const T*>(fData + offset);
+    }
+    /// Per-row lengths of a vector column block.
+    const std::uint32_t* Lengths(const Block& block) const
+    {
+      return reinterpret_cast<const std::uint32_t*>(fData + block.offset);
+    }
+
+  private:
+    template <typename T>
+    T Read(std::size_t position) const
+    {
+      T value;
+      std::memcpy(&value, fData + position, sizeof(T));
+      return value;
+    }
+
+    bool ReadString(std::size_t& position, std::string& value) const
+    {
+      if (position + 4 > fSize) return false;
+      const std::uint32_t length = Read<std::uint32_t>(position);
+      position += 4;
+      if (position + length > fSize) return false;
+      value.assign(fData + position, length);
+      position += length;
+      return true;
+    }
+
+    bool ReadFooter(std::size_t position)
+    {
+      const std::size_t end = fSize - 16;
+      if (position + 4 > end) return false;
+      const std::uint32_t nTables = Read<std::uint32_t>(position);
+      position += 4;
+      fTables.resize(nTables);
+      for (auto& table : fTables) {
+        if (!ReadString(position, table.name) || !ReadString(position, table.title)) return false;
+        if (position + 4 > end) return false;
+        table.columns.resize(Read<std::uint32_t>(position));
+        position += 4;
+        for (auto& column : table.columns) {
+          if (!ReadString(position, column.name) || position + 4 > end) return false;
+          column.type = Read<std::uint8_t>(position);
+          column.isVector = Read<std::uint8_t>(position + 1) != 0;
+          position += 4;
+        }
+        if (position + 16 > end) return false;
+        table.nRows = Read<std::uint64_t>(position);
+        const std::uint64_t nChunks = Read<std::uint64_t>(position + 8);
+        position += 16;
+        const std::size_t chunkBytes = 16 + 24 * table.columns.size();
+        if (nChunks > (end - position) / chunkBytes) return false;
+        table.chunks.resize(nChunks);
+        for (auto& chunk : table.chunks) {
+          chunk.firstRow = Read<std::uint64_t>(position);
+          chunk.nRows = Read<std::uint32_t>(position + 8);
+          position += 16;
+          chunk.blocks.resize(table.columns.size());
+          for (auto& block : chunk.blocks) {
+            block.offset = Read<std::uint64_t>(position);
+            block.bytes = Read<std::uint64_t>(position + 8);
+            block.nValues = Read<std::uint64_t>(position + 16);
+            position += 24;
+            if (block.offset + block.bytes > end) return false;
+          }
+        }
+      }
+      return true;
+    }
+
+    bool Fail(const std::string& error)
+    {
+      Close();
+      fError = error;
+      return false;
+    }
+
+    const char* fData = nullptr;
+    std::size_t fSize = 0;
+    std::vector<Table> fTables;
+    std::string fError;
+};
+
+#endif
@@ -0,0 +1,143 @@
+/// \file WaterTankColumnarWriter.hh
+/// \brief Definition of the WaterTankColumnarWriter class
+
+#ifndef WaterTankColumnarWriter_h
+#define WaterTankColumnarWriter_h 1
+
+#include "globals.hh"
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Streams ntuple rows into a columnar binary file (.wtc).
+///
+/// The booking and filling calls mirror those of G4AnalysisManager, so the
+/// same schema is written as in the ROOT ntuples (see WaterTankNtupleOutput).
+/// Rows are appended column by column to a chunk buffer per table. When a
+/// chunk is full the table switches to its second buffer and a background
+/// thread writes the full one as one block per column; the filling thread
+/// only waits if that block is still being written when the second buffer
+/// fills up in turn. The file layout and the reader are described in
+/// WaterTankColumnarReader.hh.
+///
+/// A writer belongs to one thread; in multi-threaded runs every worker
+/// writes its own file.
+
+class WaterTankColumnarWriter
+{
+  public:
+    WaterTankColumnarWriter();
+    ~WaterTankColumnarWriter();
+
+    WaterTankColumnarWriter(const WaterTankColumnarWriter&) = delete;
+    WaterTankColumnarWriter& operator=(const WaterTankColumnarWriter&) = delete;
+
+    /// Booking, as in G4AnalysisManager. Vector columns are bound to a
+    /// vector whose content is copied at each AddNtupleRow.
+    G4int CreateNtuple(const G4String& name, const G4String& title);
+    G4int CreateNtupleIColumn(const G4String& name);
+    G4int CreateNtupleFColumn(const G4String& name);
+    G4int CreateNtupleDColumn(const G4String& name);
+    G4int CreateNtupleIColumn(const G4String& name, std::vector<G4int>& vector);
+    G4int CreateNtupleFColumn(const G4String& name, std::vector<float>& vector);
+    void FinishNtuple() {}
+    /// Rows added to an inactive ntuple are dropped.
+    void SetNtupleActivation(G4int id, G4bool active) { fTables[id].active = active; }
+
+    G4bool OpenFile(const G4String& fileName);
+    /// Write the pending chunks and the footer index, then close the file.
+    void CloseFile();
+    G4bool IsOpen() const { return fFile != nullptr; }
+
+    void FillNtupleIColumn(G4int id, G4int column, G4int value) { fTables[id].staged[column].i = value; }
+    void FillNtupleFColumn(G4int id, G4int column, G4float value) { fTables[id].staged[column].f = value; }
+    void FillNtupleDColumn(G4int id, G4int column, G4double value) { fTables[id].staged[column].d = value; }
+    void AddNtupleRow(G4int id);
+
+    /// Time the filling thread spent waiting for the background writes.
+    G4double GetStallSeconds() const { return fStallSeconds; }
+
+  private:
+    /// Rows and bytes after which a chunk is handed to the writer thread.
+    static constexpr std::uint32_t kChunkRows = 65536;
+    static constexpr std::size_t kChunkBytes = 8 << 20;
+
+    union Value { std::int32_t i; float f; double d; };
+
+    struct ColumnSpec
+    {
+      G4String name;
+      std::uint8_t type;
+      /// Bound vector of a vector column; both null for scalars.
+      const std::vector<G4int>* intVector;
+      const std::vector<float>* floatVector;
+      G4bool IsVector() const { return intVector || floatVector; }
+    };
+
+    struct ChunkBuffer
+    {
+      std::vector<std::vector<char>> data;
+      std::vector<std::vector<std::uint32_t>> lengths;
+      std::uint64_t firstRow = 0;
+      std::uint32_t nRows = 0;
+      std::size_t bytes = 0;
+      /// Set while the writer thread owns the buffer (guarded by fMutex).
+      G4bool inFlight = false;
+    };
+
+    struct ChunkIndex
+    {
+      std::uint64_t firstRow;
+      std::uint32_t nRows;
+      /// Offset, bytes and number of values of each column's block.
+      std::vector<std::uint64_t> blocks;
+    };
+
+    struct Table
+    {
+      G4String name;
+      G4String title;
+      std::vector<ColumnSpec> columns;
+      std::vector<Value> staged;
+      ChunkBuffer buffers[2];
+      G4int fill = 0;
+      std::uint64_t nRows = 0;
+      G4bool active = true;
+      /// Written chunks; only the writer thread touches it while the file is open.
+      std::vector<ChunkIndex> index;
+    };
+
+    G4int AddColumn(const G4String& name, std::uint8_t type,
+                    const std::vector<G4int>* intVector = nullptr,
+                    const std::vector<float>* floatVector = nullptr);
+    /// Hand the filled buffer of a table to the writer thread.
+    void SubmitChunk(G4int id);
+    void WriterLoop();
+    void WriteChunk(Table& table, ChunkBuffer& buffer);
+    void WriteFooter();
+    void WriteBytes(const void* data, std::size_t size);
+    void Pad();
+
+    std::vector<Table> fTables;
+
+    std::FILE* fFile;
+    G4String fFileName;
+    std::uint64_t fOffset;
+    G4bool fWriteError;
+
+    std::thread fThread;
+    std::mutex fMutex;
+    std::condition_variable fCondition;
+    /// Chunks waiting for the writer thread, as (table, buffer) pairs.
+    std::deque<std::pair<G4int, G4int>> fQueue;
+    G4bool fStop;
+    G4double fStallSeconds;
+};
+
+#endif
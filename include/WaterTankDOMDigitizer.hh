@@ -0,0 +1,115 @@
+/// \file WaterTankDOMDigitizer.hh
+/// \brief Definition of the WaterTankDOMDigitizer class
+
+#ifndef WaterTankDOMDigitizer_h
+#define WaterTankDOMDigitizer_h 1
+
+#include "G4VDigitizerModule.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class WaterTankDOMSD;
+class WaterTankDOMDigitizerMessenger;
+
+/// Emulates the DOM readout: an ATWD/FADC-like sampled waveform of the PMT
+/// and the pulses extracted from it.
+///
+/// The readout window opens on the first hit of the event (minus a
+/// pretrigger) and is aligned to the sampling clock. Each hit in the DOM
+/// hit buffer adds a single-photoelectron pulse, scaled by the hit weight
+/// and an optional Gaussian charge smearing, to the samples it overlaps. The
+/// pulse shape is either a Gaussian or a Gaussian convolved with an
+/// exponential decay. Its cumulative integral is tabulated once with 16
+/// points per sample, and every sample receives the part of the pulse that
+/// falls within its clock period. Waveform samples are thus photoelectrons
+/// per sample, charge is conserved for any sampling period (pulses narrower
+/// than the clock are not lost between samples), and a hit only touches the
+/// few samples under its pulse. Pulses are runs of samples above a
+/// threshold given as a fraction of the SPE peak sample; each has an
+/// interpolated leading-edge time and the summed charge.
+///
+/// The digitizer is thread-local like the SD it reads and is registered
+/// with the thread's G4DigiManager. Its waveform and pulse buffers are
+/// reused from event to event. Settings come from /watertank/digi/.
+
+class WaterTankDOMDigitizer : public G4VDigitizerModule
+{
+  public:
+    enum PulseShape { kGaussianPulse = 0, kExpGaussPulse };
+
+    WaterTankDOMDigitizer(const G4String& name);
+    virtual ~WaterTankDOMDigitizer();
+
+    /// Digitize the hits recorded in this event.
+    virtual void Digitize();
+
+    void SetPulseShape(PulseShape shape) { fPulseShape = shape; fTemplateValid = false; }
+    /// Gaussian width (sigma) of the SPE pulse.
+    void SetPulseWidth(G4double width) { fPulseWidth = width; fTemplateValid = false; }
+    /// Exponential decay time of the expgauss pulse shape.
+    void SetPulseDecay(G4double decay) { fPulseDecay = decay; fTemplateValid = false; }
+    void SetSamplingPeriod(G4double period) { fSamplingPeriod = period; fTemplateValid = false; }
+    void SetNumberOfSamples(G4int samples) { fNumberOfSamples = samples; }
+    /// Time recorded before the first hit.
+    void SetPretrigger(G4double pretrigger) { fPretrigger = pretrigger; }
+    /// Pulse threshold as a fraction of the SPE peak sample.
+    void SetThreshold(G4double threshold) { fThreshold = threshold; }
+    /// Relative Gaussian spread of the SPE charge (0 for none).
+    void SetSPEResolution(G4double resolution) { fSPEResolution = resolution; }
+    void SetStoreWaveform(G4bool store) { fStoreWaveform = store; }
+    G4bool GetStoreWaveform() const { return fStoreWaveform; }
+
+    /// True if the last Digitize() saw at least one hit.
+    G4bool HasReadout() const { return fHasReadout; }
+    G4double GetSamplingPeriod() const { return fSamplingPeriod; }
+    /// Time of the first sample.
+    G4double GetWindowStart() const { return fWindowStart; }
+    /// Samples in photoelectrons per sample.
+    const std::vector<float>& GetWaveform() const { return fWaveform; }
+    /// Integrated charge and sample-weighted mean time of the waveform.
+    G4double GetCharge() const { return fCharge; }
+    G4double GetMeanTime() const { return fMeanTime; }
+    /// Leading-edge times and charges of the extracted pulses.
+    const std::vector<G4double>& GetPulseTimes() const { return fPulseTimes; }
+    const std::vector<float>& GetPulseCharges() const { return fPulseCharges; }
+
+  private:
+    /// Tabulate the cumulative SPE pulse for the current settings.
+    void BuildTemplate();
+    /// Fraction of the SPE charge arriving before `offset` from the hit time.
+    G4double CumulativeAt(G4double offset) const;
+    void ExtractPulses();
+
+    WaterTankDOMDigitizerMessenger* fMessenger;
+    WaterTankDOMSD* fDOMSD;
+
+    PulseShape fPulseShape;
+    G4double fPulseWidth;
+    G4double fPulseDecay;
+    G4double fSamplingPeriod;
+    G4int    fNumberOfSamples;
+    G4double fPretrigger;
+    G4double fThreshold;
+    G4double fSPEResolution;
+    G4bool   fStoreWaveform;
+
+    /// Cumulative SPE pulse, tabulated from fTemplateMin to fTemplateMax.
+    G4bool fTemplateValid;
+    std::vector<G4double> fTemplate;
+    G4double fTemplateMin;
+    G4double fTemplateMax;
+    G4double fTemplateStep;
+    /// Largest sample a single photoelectron can produce.
+    G4double fSPEPeakSample;
+
+    G4bool   fHasReadout;
+    G4double fWindowStart;
+    G4double fCharge;
+    G4double fMeanTime;
+    std::vector<float> fWaveform;
+    std::vector<G4double> fPulseTimes;
+    std::vector<float> fPulseCharges;
+};
+
+#endif
@@ -0,0 +1,47 @@
+/// \file WaterTankDOMDigitizerMessenger.hh
+/// \brief Definition of the WaterTankDOMDigitizerMessenger class
+
+#ifndef WaterTankDOMDigitizerMessenger_h
+#define WaterTankDOMDigitizerMessenger_h 1
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class WaterTankDOMDigitizer;
+class G4UIdirectory;
+class G4UIcmdWithABool;
+class G4UIcmdWithADouble;
+class G4UIcmdWithAString;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithADoubleAndUnit;
+
+/// Messenger class for WaterTankDOMDigitizer
+///
+/// This class provides UI commands under /watertank/digi/ for the DOM
+/// readout emulation: the single-photoelectron pulse shape, the sampling
+/// clock and window, and the pulse extraction threshold.
+
+class WaterTankDOMDigitizerMessenger : public G4UImessenger
+{
+  public:
+    WaterTankDOMDigitizerMessenger(WaterTankDOMDigitizer* digitizer);
+    virtual ~WaterTankDOMDigitizerMessenger();
+
+    virtual void SetNewValue(G4UIcommand* command, G4String newValue);
+
+  private:
+    WaterTankDOMDigitizer* fDigitizer;
+
+    G4UIdirectory* fDigiDirectory;
+    G4UIcmdWithAString* fPulseShapeCmd;
+    G4UIcmdWithADoubleAndUnit* fPulseWidthCmd;
+    G4UIcmdWithADoubleAndUnit* fPulseDecayCmd;
+    G4UIcmdWithADoubleAndUnit* fSamplingPeriodCmd;
+    G4UIcmdWithAnInteger* fSamplesCmd;
+    G4UIcmdWithADoubleAndUnit* fPretriggerCmd;
+    G4UIcmdWithADouble* fThresholdCmd;
+    G4UIcmdWithADouble* fSPEResolutionCmd;
+    G4UIcmdWithABool* fStoreWaveformCmd;
+};
+
+#endif
@@ -0,0 +1,138 @@
+/// \file WaterTankDOMHitBuffer.hh
+/// \brief Definition of the WaterTankDOMHitBuffer class
+
+#ifndef WaterTankDOMHitBuffer_h
+#define WaterTankDOMHitBuffer_h 1
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <cstddef>
+#include <vector>
+
+/// Per-event store of DOM photon detections, laid out as a structure of
+/// arrays.
+///
+/// Each detected photon appends one entry to a set of contiguous columns
+/// (time, energy, position, direction, weight and provenance) instead of
+/// allocating a hit object. The DOM sensitive detector owns one buffer per
+/// thread and clears it at the start of every event; clearing keeps the
+/// capacity, so after the first few events recording a hit is a handful of
+/// stores with no allocation. Readers walk the columns linearly by index.
+///
+/// Columns hold values in Geant4 internal units. The time is double
+/// precision, since global times can be far from zero (a primary with a
+/// late start time, a slow decay) where a float would round them to many
+/// ns; the other floating point columns are single precision, which is
+/// ample for energies, positions and directions.
+
+class WaterTankDOMHitBuffer
+{
+  public:
+    WaterTankDOMHitBuffer() = default;
+
+    /// Drop all hits but keep the allocated storage for the next event.
+    void Clear()
+    {
+      fTime.clear();
+      fEnergy.clear();
+      fPositionX.clear();
+      fPositionY.clear();
+      fPositionZ.clear();
+      fDirectionX.clear();
+      fDirectionY.clear();
+      fDirectionZ.clear();
+      fWeight.clear();
+      fTrackID.clear();
+      fParentID.clear();
+    }
+
+    /// Append one detection.
+    void Add(G4double time, const G4ThreeVector& position, const G4ThreeVector& direction,
+             G4double photonEnergy, G4int trackID, G4int parentID, G4double weight)
+    {
+      fTime.push_back(time);
+      fEnergy.push_back(float(photonEnergy));
+      fPositionX.push_back(float(position.x()));
+      fPositionY.push_back(float(position.y()));
+      fPositionZ.push_back(float(position.z()));
+      fDirectionX.push_back(float(direction.x()));
+      fDirectionY.push_back(float(direction.y()));
+      fDirectionZ.push_back(float(direction.z()));
+      fWeight.push_back(float(weight));
+      fTrackID.push_back(trackID);
+      fParentID.push_back(parentID);
+    }
+
+    /// Drop the hits later than `time`, keeping the order of the others.
+    /// Returns the number of hits dropped.
+    std::size_t EraseLaterThan(G4double time)
+    {
+      std::size_t kept = 0;
+      for (std::size_t i = 0; i < fTime.size(); ++i) {
+        if (fTime[i] > time) continue;
+        fTime[kept] = fTime[i];
+        fEnergy[kept] = fEnergy[i];
+        fPositionX[kept] = fPositionX[i];
+        fPositionY[kept] = fPositionY[i];
+        fPositionZ[kept] = fPositionZ[i];
+        fDirectionX[kept] = fDirectionX[i];
+        fDirectionY[kept] = fDirectionY[i];
+        fDirectionZ[kept] = fDirectionZ[i];
+        fWeight[kept] = fWeight[i];
+        fTrackID[kept] = fTrackID[i];
+        fParentID[kept] = fParentID[i];
+        ++kept;
+      }
+      const std::size_t dropped = fTime.size() - kept;
+      fTime.resize(kept);
+      fEnergy.resize(kept);
+      fPositionX.resize(kept);
+      fPositionY.resize(kept);
+      fPositionZ.resize(kept);
+      fDirectionX.resize(kept);
+      fDirectionY.resize(kept);
+      fDirectionZ.resize(kept);
+      fWeight.resize(kept);
+      fTrackID.resize(kept);
+      fParentID.resize(kept);
+      return dropped;
+    }
+
+    std::size_t Size() const { return fTime.size(); }
+    G4bool IsEmpty() const { return fTime.empty(); }
+
+    /// Column accessors; each array holds Size() entries.
+    const G4double* GetTime() const { return fTime.data(); }
+    const float* GetEnergy() const { return fEnergy.data(); }
+    const float* GetPositionX() const { return fPositionX.data(); }
+    const float* GetPositionY() const { return fPositionY.data(); }
+    const float* GetPositionZ() const { return fPositionZ.data(); }
+    const float* GetDirectionX() const { return fDirectionX.data(); }
+    const float* GetDirectionY() const { return fDirectionY.data(); }
+    const float* GetDirectionZ() const { return fDirectionZ.data(); }
+    /// Number of physical photons each hit represents (1 without bundling).
+    const float* GetWeight() const { return fWeight.data(); }
+    const G4int* GetTrackID() const { return fTrackID.data(); }
+    const G4int* GetParentID() const { return fParentID.data(); }
+
+  private:
+    /// Global arrival time at the DOM surface.
+    std::vector<G4double> fTime;
+    /// Photon energy at the DOM surface.
+    std::vector<float> fEnergy;
+    /// Arrival position on the DOM surface.
+    std::vector<float> fPositionX;
+    std::vector<float> fPositionY;
+    std::vector<float> fPositionZ;
+    /// Photon direction on arrival.
+    std::vector<float> fDirectionX;
+    std::vector<float> fDirectionY;
+    std::vector<float> fDirectionZ;
+    std::vector<float> fWeight;
+    /// Optical photon and parent track IDs.
+    std::vector<G4int> fTrackID;
+    std::vector<G4int> fParentID;
+};
+
+#endif
@@ -11,7 +11,10 @@
 #include "G4SDManager.hh"
 #include "G4ios.hh"
 
-#include "WaterTankDOMHit.hh"
+#include "WaterTankDOMHitBuffer.hh"
+#include "WaterTankPropertyTable.hh"
+
+#include <cfloat>
 
 class G4Step;
 class G4HCofThisEvent;
@@ -21,38 +24,134 @@ class G4VPhysicalVolume;
 ///
 /// The detector watches the water-to-DOM boundary and, whenever an optical
 /// photon crosses into the DOM, evaluates the optical surface acceptance and
-/// records a `WaterTankDOMHit` with the photon's kinematics. The owning code
-/// provides references to the relevant physical volumes and optical surface.
+/// records the photon's kinematics in its `WaterTankDOMHitBuffer`. The owning
+/// code provides references to the relevant physical volumes and optical
+/// surface. The buffer is per thread (like the SD) and is cleared, not freed,
+/// at the start of every event; the event action reads it at the end.
+///
+/// The SD is bound to the DOM glass only. Because the DOM surface is a
+/// dielectric_metal boundary, photons never step inside the glass; instead the
+/// stepping action forwards water-side boundary steps to ProcessBoundaryHit().
+///
+/// The SD also applies the readout window. It opens at the earliest time a
+/// charged particle is seen in the water and closes the configured time
+/// later. While the event is tracked, the entry time can only move earlier.
+/// IsAfterWindow() therefore never rejects a photon that the final window
+/// would keep, and the stepping and stacking actions can kill photons with
+/// it. Every hit is checked when it is added, whatever path created it. At
+/// the end of the event, the hits are filtered again against the final
+/// window.
 
 class WaterTankDOMSD : public G4VSensitiveDetector
 {
   public:
-    WaterTankDOMSD(const G4String& name, const G4String& hitsCollectionName);
+    WaterTankDOMSD(const G4String& name);
     virtual ~WaterTankDOMSD();
+
+    /// Name the SD is registered under with the SD manager.
+    static constexpr const char* kName = "WaterTank/DOMSD";
+    /// This thread's DOM SD, or nullptr before the geometry is constructed.
+    /// The SD is thread-local, so it is looked up through this thread's SD
+    /// manager rather than through the shared detector construction.
+    static WaterTankDOMSD* Instance()
+    {
+      return static_cast<WaterTankDOMSD*>(
+        G4SDManager::GetSDMpointer()->FindSensitiveDetector(kName, false));
+    }
   
     // methods from base class
     virtual void Initialize(G4HCofThisEvent* hitCollection);
     virtual G4bool ProcessHits(G4Step* step, G4TouchableHistory* history);
     virtual void EndOfEvent(G4HCofThisEvent* hitCollection);
 
+    /// Evaluate an optical photon step that ended on a geometry boundary while
+    /// leaving the water. Records a hit if the boundary is the DOM and the
+    /// photon passes the efficiency check; returns true when a hit was made.
+    G4bool ProcessBoundaryHit(const G4Step* step);
+
     /// Bind the DOM placement so we can recognize boundary crossings.
     void SetDOMPhysicalVolume(const G4VPhysicalVolume* domPhys) { fDOMPhysicalVolume = domPhys; }
     /// Bind the water placement, complementing the DOM volume above.
     void SetWaterPhysicalVolume(const G4VPhysicalVolume* waterPhys) { fWaterPhysicalVolume = waterPhys; }
     /// Provide the optical surface name whose efficiency curve we should sample.
     void SetDOMOpticalSurfaceName(const G4String& surfaceName) { fDOMOpticalSurfaceName = surfaceName; }
+    /// Outer DOM radius, used to recognize boundary hits by position.
+    void SetDOMRadius(G4double radius) { fDOMRadius = radius; }
+
+    /// Resolve the EFFICIENCY curve of the named water/DOM border surface into
+    /// a flat lookup table. Called once per thread after the setters above.
+    void BuildEfficiencyTable();
+
+    /// Peak detection efficiency over the tabulated energy range (1 if the DOM
+    /// has no efficiency curve).
+    G4double GetMaxEfficiency() const
+    {
+      return fEfficiencyTable.IsValid() ? fEfficiencyTable.GetMaxValue() : 1.;
+    }
+    /// Absolute detection efficiency at this energy, ignoring QE-first.
+    G4double GetEfficiency(G4double photonEnergy) const
+    {
+      return fEfficiencyTable.IsValid() ? fEfficiencyTable.Value(photonEnergy) : 1.;
+    }
+    /// QE-first mode: photons were already thinned by GetMaxEfficiency() when
+    /// they were created, so only the relative efficiency QE(E)/QEmax is
+    /// sampled at the DOM.
+    void SetQEFirst(G4bool qeFirst);
+
+    /// Probability that a photon of this energy reaching the DOM surface is
+    /// detected, including the QE-first scaling (not clamped).
+    G4double GetDetectionProbability(G4double photonEnergy) const;
+    /// Draw the detection decision for a given probability. Probabilities of
+    /// one or more are accepted without consuming a random number.
+    G4bool SampleDetection(G4double detectionProbability) const;
+    /// Record a detected photon. Used by the boundary path above and by
+    /// photon propagation that bypasses Geant4 tracking. The weight is the
+    /// number of physical photons the detection represents.
+    void AddHit(G4double time, const G4ThreeVector& position,
+                const G4ThreeVector& direction, G4double photonEnergy,
+                G4int trackID, G4int parentID, G4double weight = 1.);
+
+    /// Readout window length; zero disables the window.
+    void SetTimeWindow(G4double window) { fTimeWindow = window; }
+    /// Record a charged particle in the water; the earliest time opens the
+    /// readout window.
+    void MarkWaterEntry(G4double time) { if (time < fWaterEntryTime) fWaterEntryTime = time; }
+    /// Time the first charged particle was seen in the water (DBL_MAX if none).
+    G4double GetWaterEntryTime() const { return fWaterEntryTime; }
+    /// True if a photon at this time is past the window as known so far.
+    G4bool IsAfterWindow(G4double time) const
+    {
+      return fTimeWindow > 0. && time > fWaterEntryTime + fTimeWindow;
+    }
+    /// Count an optical photon killed, or a hit dropped, by the readout window.
+    void AddKilledLatePhoton() { ++fKilledLatePhotons; }
+    /// Photons killed and hits dropped by the readout window this event.
+    G4int GetKilledLatePhotons() const { return fKilledLatePhotons; }
+
+    /// Detections recorded so far in the current event.
+    const WaterTankDOMHitBuffer& GetHitBuffer() const { return fHitBuffer; }
 
   private:
-  /// Per-event hits collection pushed into the event at initialization.
-  WaterTankDOMHitsCollection* fHitsCollection;
-  /// Cached ID used to register the hits collection with the event.
-  G4int                       fHitsCollectionID;
+  /// This thread's detections for the current event.
+  WaterTankDOMHitBuffer       fHitBuffer;
   /// Physical placement of the DOM glass sphere.
   const G4VPhysicalVolume*    fDOMPhysicalVolume = nullptr;
   /// Physical placement of the enclosing water volume.
   const G4VPhysicalVolume*    fWaterPhysicalVolume = nullptr;
   /// Name of the logical border surface modeling DOM efficiency.
   G4String                    fDOMOpticalSurfaceName;
+  /// Outer radius of the DOM sphere, provided by the detector construction.
+  G4double                    fDOMRadius = 0.;
+  /// DOM detection efficiency vs. photon energy; invalid if no curve exists.
+  WaterTankPropertyTable      fEfficiencyTable;
+  /// Factor applied to the tabulated efficiency (1/QEmax in QE-first mode).
+  G4double                    fEfficiencyScale = 1.;
+  /// Readout window after the first charged particle in the water (0: off).
+  G4double                    fTimeWindow = 0.;
+  /// First charged-particle time in the water this event.
+  G4double                    fWaterEntryTime = DBL_MAX;
+  /// Photons killed and hits dropped by the readout window this event.
+  G4int                       fKilledLatePhotons = 0;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -9,6 +9,8 @@
 
 class G4VPhysicalVolume;
 class G4LogicalVolume;
+class G4OpticalSurface;
+class G4Region;
 
 /// Detector construction that defines the full IceCube-in-a-tank setup.
 ///
@@ -28,18 +30,35 @@ class WaterTankDetectorConstruction : public G4VUserDetectorConstruction
 
     /// Accessor to the volume in which energy deposition is tallied.
     G4LogicalVolume* GetScoringVolume() const { return fScoringVolume; }
+    /// Accessor to the tank water, whose solid and optical tables describe the
+    /// medium photons propagate through.
+    const G4LogicalVolume* GetWaterLogicalVolume() const { return fWaterLogicalVolume; }
+    /// Accessor to the water placement bordering the DOM.
+    const G4VPhysicalVolume* GetWaterPhysicalVolume() const { return fWaterPhysicalVolume; }
+    /// Accessor to the DOM placement used for boundary hit detection.
+    const G4VPhysicalVolume* GetDOMPhysicalVolume() const { return fDOMPhysicalVolume; }
+    /// Outer radius of the DOM glass sphere.
+    G4double GetDOMRadius() const { return fDOMRadius; }
+    /// Optical surface between water and DOM (efficiency and reflectivity).
+    const G4OpticalSurface* GetDOMOpticalSurface() const { return fDOMOpticalSurface; }
 
   protected:
   /// Water volume we use to compute calorimetric observables.
   G4LogicalVolume*   fScoringVolume;
   /// Logical representation of the DOM glass sphere.
   G4LogicalVolume*   fDOMLogicalVolume;
-  /// Logical volume for the bulk tank water used for SD binding.
+  /// Logical volume for the bulk tank water.
   G4LogicalVolume*   fWaterLogicalVolume;
   /// Physical placement of the water volume (needed to configure surfaces).
   G4VPhysicalVolume* fWaterPhysicalVolume;
   /// Physical placement of the DOM sphere (needed for the sensitive detector).
   G4VPhysicalVolume* fDOMPhysicalVolume;
+  /// Outer radius of the DOM sphere, shared with the sensitive detector.
+  G4double           fDOMRadius;
+  /// Optical surface bound to the water/DOM border.
+  G4OpticalSurface*  fDOMOpticalSurface;
+  /// Region of the tank water, envelope of the muon fast-simulation model.
+  G4Region*          fWaterRegion;
 };
 
 #endif
@@ -7,15 +7,19 @@
 #include "G4UserEventAction.hh"
 #include "globals.hh"
 
+#include "WaterTankTimeStatistics.hh"
+
 class WaterTankRunAction;
+class WaterTankDOMSD;
+class WaterTankDOMDigitizer;
 
 /// Handles per-event bookkeeping, including DOM hit extraction.
 ///
 /// For every event we reset the running totals, collect the total energy
-/// deposited in the water scoring volume, and extract hits produced by
-/// the DOM sensitive detector. The run action receives the accumulated
-/// energy and the analysis manager records both scalar event summaries and
-/// detailed per-hit information.
+/// deposited in the water scoring volume, and read the hits the DOM
+/// sensitive detector stored in its per-thread hit buffer. The run action
+/// receives the accumulated energy and the analysis manager records both
+/// scalar event summaries and detailed per-hit information.
 
 class WaterTankEventAction : public G4UserEventAction
 {
@@ -33,10 +37,14 @@ class WaterTankEventAction : public G4UserEventAction
     WaterTankRunAction* fRunAction;
     /// Energy deposited during the current event.
     G4double     fEdep;
-    /// How many DOM photon hits were recorded this event.
-    G4int        fDetectionCount;
-    /// Cached DOM hits collection ID to avoid repeated lookups.
-    G4int        fDOMHCID;
+    /// Weighted number of DOM photon hits recorded this event.
+    G4double     fDetectionCount;
+    /// This thread's DOM sensitive detector, owner of the hit buffer.
+    WaterTankDOMSD* fDOMSD;
+    /// This thread's DOM readout emulation (owned by the G4DigiManager).
+    WaterTankDOMDigitizer* fDigitizer;
+    /// Hit-time statistics kernel; keeps its scratch buffer across events.
+    WaterTankTimeStatistics fTimeStatistics;
 };
 
 #endif
@@ -0,0 +1,70 @@
+/// \file WaterTankHitAliases.hh
+/// \brief Tree aliases giving the domhits columns in physical units
+
+#ifndef WaterTankHitAliases_h
+#define WaterTankHitAliases_h 1
+
+#include "WaterTankOutputEncoding.hh"
+
+/// Helpers for ROOT macros reading the domhits tree.
+///
+/// Depending on the layout and precision options a file was written with,
+/// a hit quantity is a double (row layout), a float, or fixed-point ticks
+/// with the step in a per-event column (vector layout). AliasHitColumns()
+/// defines tree aliases so that Time_ns, Energy_eV, Wavelength_nm,
+/// PosX/Y/Z_cm and DirX/Y/Z always give the physical value, and macros can
+/// use these names on any file. Columns that are present are left as they
+/// are. The tree type is a template parameter so that the header, like
+/// WaterTankOutputEncoding.hh, only needs the standard library.
+
+/// Direction components of a packed octahedral direction, for use in
+/// TTree::Draw expressions.
+inline double WaterTankDirOctX(double packed)
+{
+  double x, y, z;
+  WaterTankOutputEncoding::DecodeOctahedral(int(packed), x, y, z);
+  return x;
+}
+
+inline double WaterTankDirOctY(double packed)
+{
+  double x, y, z;
+  WaterTankOutputEncoding::DecodeOctahedral(int(packed), x, y, z);
+  return y;
+}
+
+inline double WaterTankDirOctZ(double packed)
+{
+  double x, y, z;
+  WaterTankOutputEncoding::DecodeOctahedral(int(packed), x, y, z);
+  return z;
+}
+
+template <class Tree>
+void AliasHitColumns(Tree* tree)
+{
+  // Vector layout: times are offsets from the event's first hit.
+  if (tree->GetBranch("Time_ticks")) {
+    tree->SetAlias("Time_ns", "TimeReference_ns+Time_ticks*TimeStep_ns");
+  }
+  else if (tree->GetBranch("TimeOffset_ns")) {
+    tree->SetAlias("Time_ns", "TimeReference_ns+TimeOffset_ns");
+  }
+  // A quantized energy drops the wavelength; hc = 1239.84198 eV nm.
+  if (tree->GetBranch("Energy_ticks")) {
+    tree->SetAlias("Energy_eV", "Energy_ticks*EnergyStep_eV");
+    tree->SetAlias("Wavelength_nm", "1239.84198/Energy_eV");
+  }
+  if (tree->GetBranch("PosX_ticks")) {
+    tree->SetAlias("PosX_cm", "PosX_ticks*PositionStep_cm");
+    tree->SetAlias("PosY_cm", "PosY_ticks*PositionStep_cm");
+    tree->SetAlias("PosZ_cm", "PosZ_ticks*PositionStep_cm");
+  }
+  if (tree->GetBranch("DirOct")) {
+    tree->SetAlias("DirX", "WaterTankDirOctX(DirOct)");
+    tree->SetAlias("DirY", "WaterTankDirOctY(DirOct)");
+    tree->SetAlias("DirZ", "WaterTankDirOctZ(DirOct)");
+  }
+}
+
+#endif
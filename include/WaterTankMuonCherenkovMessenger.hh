@@ -0,0 +1,35 @@
+/// \file WaterTankMuonCherenkovMessenger.hh
+/// \brief Definition of the WaterTankMuonCherenkovMessenger class
+
+#ifndef WaterTankMuonCherenkovMessenger_h
+#define WaterTankMuonCherenkovMessenger_h 1
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class WaterTankMuonCherenkovModel;
+class G4UIcmdWithAString;
+class G4UIcmdWithADoubleAndUnit;
+
+/// Messenger class for WaterTankMuonCherenkovModel
+///
+/// This class provides UI commands under /watertank/optics/ to switch muon
+/// Cherenkov light between full photon tracking and the fast analytic model,
+/// and to set the segment length the fast model samples light on.
+
+class WaterTankMuonCherenkovMessenger : public G4UImessenger
+{
+  public:
+    WaterTankMuonCherenkovMessenger(WaterTankMuonCherenkovModel* model);
+    virtual ~WaterTankMuonCherenkovMessenger();
+
+    virtual void SetNewValue(G4UIcommand* command, G4String newValue);
+
+  private:
+    WaterTankMuonCherenkovModel* fModel;
+
+    G4UIcmdWithAString* fModeCmd;
+    G4UIcmdWithADoubleAndUnit* fSegmentLengthCmd;
+};
+
+#endif
@@ -0,0 +1,103 @@
+/// \file WaterTankMuonCherenkovModel.hh
+/// \brief Definition of the WaterTankMuonCherenkovModel class
+
+#ifndef WaterTankMuonCherenkovModel_h
+#define WaterTankMuonCherenkovModel_h 1
+
+#include "G4VFastSimulationModel.hh"
+#include "G4EmCalculator.hh"
+#include "globals.hh"
+
+#include "WaterTankOpticalGeometry.hh"
+#include "WaterTankPhotonPropagator.hh"
+
+#include <vector>
+
+class WaterTankDetectorConstruction;
+class WaterTankDOMSD;
+class WaterTankMuonCherenkovMessenger;
+
+/// Fast simulation of muons in the tank water ("fast" optical mode).
+///
+/// In full mode (the default) the model never triggers and muons are tracked
+/// by Geant4, with G4Cerenkov stacking every photon. In fast mode the model
+/// takes over muons in the water region and moves them in one straight step
+/// to the tank wall or the DOM, depositing the mean (unrestricted) energy
+/// loss. Along that path the Frank-Tamm yield is evaluated in short segments;
+/// for each segment the fraction of the Cherenkov cone that intersects the
+/// DOM is computed analytically and attenuated by absorption, giving the
+/// expected photons reaching the DOM per segment. A Poisson number of them is
+/// sampled on the intersecting arc of the cone, and each meets the DOM
+/// surface as in full tracking: it is detected with the DOM efficiency and
+/// recorded through the DOM sensitive detector, or reflected with the surface
+/// reflectivity and ray-traced on, or absorbed. No optical photons are
+/// created.
+///
+/// Rayleigh scattering on the way to the DOM is neglected (scattering lengths
+/// are tens of meters against a ~1 m tank), as are delta rays and multiple
+/// scattering of the muon; the mode is meant for throughput comparisons on identical events
+/// via /watertank/optics/mode.
+
+class WaterTankMuonCherenkovModel : public G4VFastSimulationModel
+{
+  public:
+    WaterTankMuonCherenkovModel(const G4String& name, G4Region* envelope,
+                                const WaterTankDetectorConstruction* detector,
+                                WaterTankDOMSD* domSD);
+    virtual ~WaterTankMuonCherenkovModel();
+
+    virtual G4bool IsApplicable(const G4ParticleDefinition& particle);
+    virtual G4bool ModelTrigger(const G4FastTrack& fastTrack);
+    virtual void   DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep);
+
+    /// Select fast (true) or full (false) optical simulation of muons.
+    void SetFastMode(G4bool fast) { fFastMode = fast; }
+    G4bool IsFastMode() const { return fFastMode; }
+    /// Length of the track segments used to sample the Cherenkov light.
+    void SetSegmentLength(G4double length) { fSegmentLength = length; }
+
+  private:
+    /// Read the water tables into per-energy-bin arrays.
+    void Configure();
+    /// Straight-line distance the muon can travel in the water before it
+    /// reaches the tank wall or the DOM.
+    G4double DistanceInWater(const G4ThreeVector& position,
+                             const G4ThreeVector& direction) const;
+    /// Sample DOM hits for one segment centered on `position`.
+    void GenerateSegmentHits(const G4ThreeVector& position, const G4ThreeVector& direction,
+                             G4double time, G4double beta, G4double charge,
+                             G4double length, G4int parentID);
+    /// Apply the DOM surface to a photon that reached it: record a hit, or
+    /// follow its reflections until it is detected or lost.
+    void SampleDOMSurface(WaterTankPhotonPropagator::Photon& photon, G4int parentID);
+    /// Half-width in azimuth of the part of a Cherenkov cone (polar angle
+    /// theta around the track) that intersects the DOM, which is seen at
+    /// angle psi from the track with angular radius alpha.
+    static G4double ConeHalfArc(G4double cosTheta, G4double sinTheta,
+                                G4double cosPsi, G4double sinPsi, G4double cosAlpha);
+
+    const WaterTankDetectorConstruction* fDetector;
+    WaterTankDOMSD* fDOMSD;
+    WaterTankMuonCherenkovMessenger* fMessenger;
+
+    G4bool   fFastMode;
+    G4double fSegmentLength;
+    G4bool   fConfigured;
+
+    WaterTankOpticalGeometry fGeometry;
+    /// Transports photons reflected off the DOM.
+    WaterTankPhotonPropagator fPropagator;
+    G4EmCalculator fEmCalculator;
+
+    /// Photon energy bins spanning the water RINDEX range, with the per-bin
+    /// refractive index, absorption length and group velocity.
+    G4double fEnergyMin;
+    G4double fEnergyWidth;
+    std::vector<G4double> fRefractiveIndex;
+    std::vector<G4double> fAbsorptionLength;
+    std::vector<G4double> fGroupVelocity;
+    /// Scratch buffer with the expected arrivals per energy bin.
+    std::vector<G4double> fBinYield;
+};
+
+#endif
@@ -0,0 +1,131 @@
+/// \file WaterTankNtupleOutput.hh
+/// \brief Definition of the WaterTankNtupleOutput class
+
+#ifndef WaterTankNtupleOutput_h
+#define WaterTankNtupleOutput_h 1
+
+#include "WaterTankColumnarWriter.hh"
+#include "WaterTankOutputQueue.hh"
+
+#include "G4AnalysisManager.hh"
+#include "globals.hh"
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+/// Ntuple booking and filling for the ROOT and columnar backends.
+///
+/// The run and event actions book and fill the ntuples through this class
+/// with the G4AnalysisManager calls. It forwards each call to the analysis
+/// manager and/or the columnar writer, depending on the output format, so
+/// both files share one schema and the same ntuple and column ids. One
+/// instance lives in each thread's run action.
+///
+/// With a queue capacity above zero and columnar output, the columnar fills
+/// of an event are recorded instead and SubmitEvent() hands them to a writer
+/// thread (see WaterTankOutputQueue), which replays them on the columnar
+/// writer while the worker goes on tracking. The analysis manager is only
+/// ever called from the owning thread: it is thread-local, and Geant4 does
+/// not support using it, or raising G4Exceptions through it, from a thread
+/// it does not know. ROOT fills therefore stay synchronous. The columnar
+/// writer is only used by one thread at a time: the writer thread between
+/// submissions, the owning thread after the queue is drained, which every
+/// file, activation and close call does first. Its vector columns are bound
+/// to internal vectors that the replay loads from the recorded copies, so
+/// the event action can refill its own vectors for the next event.
+
+class WaterTankNtupleOutput
+{
+  public:
+    enum Format { kRootFormat = 0, kColumnarFormat, kRootAndColumnarFormat };
+
+    WaterTankNtupleOutput();
+    ~WaterTankNtupleOutput();
+
+    void SetFormat(Format format) { fFormat = format; }
+    Format GetFormat() const { return fFormat; }
+    G4bool WritesRoot() const { return fFormat != kColumnarFormat; }
+    G4bool WritesColumnar() const { return fFormat != kRootFormat; }
+    const WaterTankColumnarWriter& GetColumnarWriter() const { return fColumnar; }
+
+    /// Events the writer thread may lag behind; 0 writes synchronously, as
+    /// does an output without columnar file. Set before booking, then
+    /// StartQueue() once the ntuples are booked.
+    void SetQueueCapacity(G4int capacity) { fQueueCapacity = capacity; }
+    void StartQueue();
+    /// The event output queue, or null when writing synchronously.
+    WaterTankOutputQueue* GetQueue() { return fQueue.get(); }
+
+    G4int CreateNtuple(const G4String& name, const G4String& title);
+    void CreateNtupleIColumn(const G4String& name);
+    void CreateNtupleFColumn(const G4String& name);
+    void CreateNtupleDColumn(const G4String& name);
+    void CreateNtupleIColumn(const G4String& name, std::vector<G4int>& vector);
+    void CreateNtupleFColumn(const G4String& name, std::vector<float>& vector);
+    void FinishNtuple();
+    void SetNtupleActivation(G4int id, G4bool active);
+
+    /// Open the ROOT file and, unless `columnarName` is empty, the columnar one.
+    void OpenFile(const G4String& rootName, const G4String& columnarName);
+    void CloseFile();
+
+    void FillNtupleIColumn(G4int id, G4int column, G4int value)
+    {
+      if (WritesRoot()) fAnalysisManager->FillNtupleIColumn(id, column, value);
+      if (fQueue) Record(WaterTankOutputRecord::kFillI, id, column).value.i = value;
+      else if (WritesColumnar()) fColumnar.FillNtupleIColumn(id, column, value);
+    }
+    void FillNtupleFColumn(G4int id, G4int column, G4float value)
+    {
+      if (WritesRoot()) fAnalysisManager->FillNtupleFColumn(id, column, value);
+      if (fQueue) Record(WaterTankOutputRecord::kFillF, id, column).value.f = value;
+      else if (WritesColumnar()) fColumnar.FillNtupleFColumn(id, column, value);
+    }
+    void FillNtupleDColumn(G4int id, G4int column, G4double value)
+    {
+      if (WritesRoot()) fAnalysisManager->FillNtupleDColumn(id, column, value);
+      if (fQueue) Record(WaterTankOutputRecord::kFillD, id, column).value.d = value;
+      else if (WritesColumnar()) fColumnar.FillNtupleDColumn(id, column, value);
+    }
+    void AddNtupleRow(G4int id);
+    /// End of the event's output: queue its record for the writer thread.
+    void SubmitEvent();
+    /// Wait until the writer thread replayed every submitted event, so the
+    /// backends hold all rows filled so far.
+    void Drain() { if (fQueue) fQueue->Drain(); }
+
+  private:
+    /// Vector columns of one ntuple in booking order: the vector filled by
+    /// the caller and the one bound to the columnar writer (the same without
+    /// queue). The analysis manager is always bound to the caller's vector.
+    struct Bindings
+    {
+      std::vector<std::pair<const std::vector<G4int>*, std::vector<G4int>*>> ints;
+      std::vector<std::pair<const std::vector<float>*, std::vector<float>*>> floats;
+    };
+
+    WaterTankOutputRecord::Operation& Record(WaterTankOutputRecord::Kind kind, G4int id, G4int column)
+    {
+      auto& operations = fQueue->Current().operations;
+      operations.push_back({kind, id, column, {0}});
+      return operations.back();
+    }
+    void Replay(WaterTankOutputRecord& record);
+    /// Whether the columnar fills go through the writer thread.
+    G4bool Queues() const { return fQueueCapacity > 0 && WritesColumnar(); }
+
+    /// This thread's analysis manager; only called from this thread.
+    G4AnalysisManager* fAnalysisManager;
+    Format fFormat;
+    WaterTankColumnarWriter fColumnar;
+
+    G4int fQueueCapacity;
+    std::vector<Bindings> fBindings;
+    /// Vectors bound to the columnar writer when queued (stable addresses).
+    std::deque<std::vector<G4int>> fBoundInts;
+    std::deque<std::vector<float>> fBoundFloats;
+    std::unique_ptr<WaterTankOutputQueue> fQueue;
+};
+
+#endif
@@ -0,0 +1,61 @@
+/// \file WaterTankOpticalGeometry.hh
+/// \brief Definition of the WaterTankOpticalGeometry class
+
+#ifndef WaterTankOpticalGeometry_h
+#define WaterTankOpticalGeometry_h 1
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+class WaterTankDetectorConstruction;
+
+/// Analytic description of the optical volume: a water cylinder centered on
+/// the origin with a single DOM sphere inside it.
+///
+/// Photon bookkeeping outside the Geant4 navigator (stacking decisions,
+/// analytic propagation, response tables) only needs straight-line distances
+/// to the DOM and to the tank wall. Photons reaching the tank wall are lost,
+/// since the polypropylene shell has no optical properties. Dimensions are read
+/// from the solids built by WaterTankDetectorConstruction so the two stay in
+/// sync.
+
+class WaterTankOpticalGeometry
+{
+  public:
+    WaterTankOpticalGeometry();
+    ~WaterTankOpticalGeometry();
+
+    /// Copy tank and DOM dimensions from the constructed geometry.
+    /// Returns false if the expected solids are not available yet.
+    G4bool Configure(const WaterTankDetectorConstruction* detector);
+
+    G4bool IsConfigured() const { return fConfigured; }
+
+    /// Distance along `dir` until the ray meets the DOM sphere, zero if `pos`
+    /// is already inside it, or DBL_MAX if the ray misses it.
+    G4double DistanceToDOM(const G4ThreeVector& pos, const G4ThreeVector& dir) const;
+    /// Distance along `dir` from a point inside the water to the tank wall.
+    G4double DistanceToWall(const G4ThreeVector& pos, const G4ThreeVector& dir) const;
+    /// Fraction of the full solid angle subtended by the DOM as seen from `pos`.
+    G4double DOMSolidAngleFraction(const G4ThreeVector& pos) const;
+    /// True if `pos` lies inside the water cylinder but outside the DOM.
+    G4bool   IsInWater(const G4ThreeVector& pos) const;
+
+    G4double GetTankRadius() const { return fTankRadius; }
+    G4double GetTankHalfHeight() const { return fTankHalfHeight; }
+    const G4ThreeVector& GetDOMCenter() const { return fDOMCenter; }
+    G4double GetDOMRadius() const { return fDOMRadius; }
+
+  private:
+    G4bool        fConfigured;
+    /// Radius of the water cylinder.
+    G4double      fTankRadius;
+    /// Half-height of the water cylinder.
+    G4double      fTankHalfHeight;
+    /// Global position of the DOM center.
+    G4ThreeVector fDOMCenter;
+    /// Outer radius of the DOM sphere.
+    G4double      fDOMRadius;
+};
+
+#endif
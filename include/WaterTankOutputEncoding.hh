@@ -0,0 +1,74 @@
+/// \file WaterTankOutputEncoding.hh
+/// \brief Fixed-point encodings used by the quantized domhits columns
+
+#ifndef WaterTankOutputEncoding_h
+#define WaterTankOutputEncoding_h 1
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+/// Encoders and decoders for the quantized output columns.
+///
+/// The header only depends on the standard library so that ROOT macros can
+/// include it to decode the columns:
+/// - Quantized scalars are stored as the nearest integer number of steps; the
+///   value is ticks * step. Hit times are quantized as offsets from the
+///   event's TimeReference_ns, so they stay small at any global time. Values
+///   beyond the int range are clamped to it.
+/// - Unit directions use the octahedral encoding: the direction is projected
+///   onto the octahedron |x| + |y| + |z| = 1, the lower half is folded over
+///   the upper one, and the two remaining coordinates are stored as int16
+///   packed in one 32-bit integer. The angular error is below 1e-4 rad.
+namespace WaterTankOutputEncoding
+{
+  /// Nearest integer number of steps; values out of the int range are
+  /// clamped and counted in `nClamped`.
+  inline int Quantize(double value, double step, long& nClamped)
+  {
+    const double ticks = std::round(value / step);
+    if (ticks >= double(std::numeric_limits<int>::min())
+        && ticks <= double(std::numeric_limits<int>::max())) {
+      return int(ticks);
+    }
+    ++nClamped;
+    return ticks < 0. ? std::numeric_limits<int>::min() : std::numeric_limits<int>::max();
+  }
+
+  inline int EncodeOctahedral(double x, double y, double z)
+  {
+    const double norm = std::fabs(x) + std::fabs(y) + std::fabs(z);
+    if (norm <= 0.) return 0;
+    double u = x / norm;
+    double v = y / norm;
+    if (z < 0.) {
+      const double foldedU = (1. - std::fabs(v)) * (u >= 0. ? 1. : -1.);
+      const double foldedV = (1. - std::fabs(u)) * (v >= 0. ? 1. : -1.);
+      u = foldedU;
+      v = foldedV;
+    }
+    const auto qu = std::int16_t(std::lround(u * 32767.));
+    const auto qv = std::int16_t(std::lround(v * 32767.));
+    return int(std::uint32_t(std::uint16_t(qu)) | (std::uint32_t(std::uint16_t(qv)) << 16));
+  }
+
+  inline void DecodeOctahedral(int packed, double& x, double& y, double& z)
+  {
+    const auto bits = std::uint32_t(packed);
+    double u = std::int16_t(std::uint16_t(bits & 0xFFFFu)) / 32767.;
+    double v = std::int16_t(std::uint16_t(bits >> 16)) / 32767.;
+    z = 1. - std::fabs(u) - std::fabs(v);
+    if (z < 0.) {
+      const double unfoldedU = (1. - std::fabs(v)) * (u >= 0. ? 1. : -1.);
+      const double unfoldedV = (1. - std::fabs(u)) * (v >= 0. ? 1. : -1.);
+      u = unfoldedU;
+      v = unfoldedV;
+    }
+    const double norm = std::sqrt(u*u + v*v + z*z);
+    x = u / norm;
+    y = v / norm;
+    z /= norm;
+  }
+}
+
+#endif
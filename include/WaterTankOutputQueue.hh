@@ -0,0 +1,152 @@
+/// \file WaterTankOutputQueue.hh
+/// \brief Definition of the WaterTankOutputQueue class
+
+#ifndef WaterTankOutputQueue_h
+#define WaterTankOutputQueue_h 1
+
+#include "globals.hh"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// The ntuple calls of one event, recorded to be replayed on the writer
+/// thread. Fills keep their value; a row keeps a copy of the ntuple's bound
+/// vector columns, in booking order. The storage is reused between events.
+struct WaterTankOutputRecord
+{
+  enum Kind : char { kFillI = 'I', kFillF = 'F', kFillD = 'D', kAddRow = 'R' };
+  struct Operation
+  {
+    Kind kind;
+    G4int ntuple;
+    G4int column;
+    union { G4int i; G4float f; G4double d; } value;
+  };
+
+  std::vector<Operation> operations;
+  std::vector<std::vector<G4int>> intVectors;
+  std::vector<std::vector<float>> floatVectors;
+  /// Vectors of the storage above used by this event.
+  std::size_t nIntVectors = 0;
+  std::size_t nFloatVectors = 0;
+
+  void Clear()
+  {
+    operations.clear();
+    nIntVectors = nFloatVectors = 0;
+  }
+};
+
+/// Bounded single-producer single-consumer ring of pointers; lock-free, with
+/// one slot left empty to tell a full ring from an empty one.
+template <typename T>
+class WaterTankSPSCRing
+{
+  public:
+    explicit WaterTankSPSCRing(std::size_t capacity) : fSlots(capacity + 1), fHead(0), fTail(0) {}
+
+    G4bool Push(T value)
+    {
+      const std::size_t tail = fTail.load(std::memory_order_relaxed);
+      const std::size_t next = tail + 1 == fSlots.size() ? 0 : tail + 1;
+      if (next == fHead.load(std::memory_order_acquire)) return false;
+      fSlots[tail] = value;
+      fTail.store(next, std::memory_order_release);
+      return true;
+    }
+    G4bool Pop(T& value)
+    {
+      const std::size_t head = fHead.load(std::memory_order_relaxed);
+      if (head == fTail.load(std::memory_order_acquire)) return false;
+      value = fSlots[head];
+      fHead.store(head + 1 == fSlots.size() ? 0 : head + 1, std::memory_order_release);
+      return true;
+    }
+    std::size_t Size() const
+    {
+      const std::size_t head = fHead.load(std::memory_order_acquire);
+      const std::size_t tail = fTail.load(std::memory_order_acquire);
+      return tail >= head ? tail - head : tail + fSlots.size() - head;
+    }
+    std::size_t Capacity() const { return fSlots.size() - 1; }
+
+  private:
+    std::vector<T> fSlots;
+    alignas(64) std::atomic<std::size_t> fHead;
+    alignas(64) std::atomic<std::size_t> fTail;
+};
+
+/// Hands the output of each event from a worker thread to a dedicated
+/// writer thread.
+///
+/// The worker records an event into Current() and calls Submit(), which
+/// pushes it onto a bounded lock-free queue and returns at once; the writer
+/// thread pops records and passes them to the consumer, then returns them
+/// through a second ring for reuse, so the steady state allocates nothing.
+/// The rings stay lock-free; the mutex only guards the condition variables,
+/// so an idle writer thread sleeps until a push or shutdown wakes it, and a
+/// waiting worker until a record was consumed.
+/// When the queue is full the worker waits for a free slot (backpressure);
+/// the time spent waiting and the queue depth seen at each submission are
+/// counted. Drain() returns once every submitted record was consumed, after
+/// which the worker may touch the consumer's state itself again.
+
+class WaterTankOutputQueue
+{
+  public:
+    using Consumer = std::function<void(WaterTankOutputRecord&)>;
+
+    WaterTankOutputQueue(std::size_t capacity, Consumer consumer);
+    ~WaterTankOutputQueue();
+
+    WaterTankOutputQueue(const WaterTankOutputQueue&) = delete;
+    WaterTankOutputQueue& operator=(const WaterTankOutputQueue&) = delete;
+
+    /// The record being filled by the worker.
+    WaterTankOutputRecord& Current() { return *fCurrent; }
+    /// Queue the current record and start a new one.
+    void Submit();
+    /// Wait until the writer thread consumed every submitted record.
+    void Drain();
+
+    /// Counters since the last ResetStatistics().
+    void ResetStatistics();
+    G4long GetSubmitted() const { return fSubmittedSinceReset; }
+    G4double GetDepthSum() const { return fDepthSum; }
+    G4int GetMaxDepth() const { return fMaxDepth; }
+    G4long GetStalls() const { return fStalls; }
+    G4double GetStallSeconds() const { return fStallSeconds; }
+
+  private:
+    void WriterLoop();
+
+    Consumer fConsumer;
+    std::vector<std::unique_ptr<WaterTankOutputRecord>> fRecords;
+    WaterTankOutputRecord* fCurrent;
+    WaterTankSPSCRing<WaterTankOutputRecord*> fFull;
+    WaterTankSPSCRing<WaterTankOutputRecord*> fFree;
+
+    /// Records submitted (worker) and consumed (writer thread).
+    G4long fSubmitted;
+    std::atomic<G4long> fConsumed;
+    std::atomic<G4bool> fStop;
+    /// Wakes the writer thread on a push or shutdown (fWork) and the worker
+    /// once a record was consumed (fDone).
+    std::mutex fMutex;
+    std::condition_variable fWork;
+    std::condition_variable fDone;
+    std::thread fThread;
+
+    G4long fSubmittedSinceReset;
+    G4double fDepthSum;
+    G4int fMaxDepth;
+    G4long fStalls;
+    G4double fStallSeconds;
+};
+
+#endif
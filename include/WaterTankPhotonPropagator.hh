@@ -0,0 +1,79 @@
+/// \file WaterTankPhotonPropagator.hh
+/// \brief Definition of the WaterTankPhotonPropagator class
+
+#ifndef WaterTankPhotonPropagator_h
+#define WaterTankPhotonPropagator_h 1
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include "WaterTankOpticalGeometry.hh"
+#include "WaterTankPropertyTable.hh"
+
+class WaterTankDetectorConstruction;
+
+/// Analytic optical photon transport for the cylinder-plus-sphere tank.
+///
+/// The optical volume is a water cylinder with one DOM sphere and no other
+/// optical surface; photons reaching the tank wall are lost because the
+/// polypropylene has no refractive index. That makes it possible to ray-trace
+/// photons without the Geant4 navigator: sample absorption and Rayleigh
+/// distances from the same water ABSLENGTH/RAYLEIGH tables, advance the photon
+/// to the nearest of those or the DOM/wall intersection, and scatter with the
+/// unpolarized Rayleigh phase function. Arrival times use the water GROUPVEL
+/// table, as G4Transportation does for optical photons.
+///
+/// The caller decides what happens at the DOM surface (detection efficiency,
+/// hit recording) and may ask for a specular reflection with the surface
+/// reflectivity, mirroring the dielectric_metal boundary.
+
+class WaterTankPhotonPropagator
+{
+  public:
+    /// State of a photon being propagated. Energy is constant along the way.
+    struct Photon {
+      G4ThreeVector position;
+      G4ThreeVector direction;
+      G4double      time;
+      G4double      energy;
+    };
+
+    WaterTankPhotonPropagator();
+    ~WaterTankPhotonPropagator();
+
+    /// Read geometry and optical tables. Returns false if they are missing.
+    G4bool Configure(const WaterTankDetectorConstruction* detector);
+    G4bool IsConfigured() const { return fConfigured; }
+
+    const WaterTankOpticalGeometry& GetGeometry() const { return fGeometry; }
+
+    /// Advance the photon until it reaches the DOM surface (returns true, with
+    /// the photon on the surface) or is absorbed or leaves the water (false).
+    G4bool TransportToDOM(Photon& photon) const;
+    /// For a photon sitting on the DOM surface, sample the surface
+    /// reflectivity and reflect it specularly; false if it is absorbed.
+    G4bool ReflectOffDOM(Photon& photon) const;
+
+    /// Photon group velocity in water.
+    G4double GetGroupVelocity(G4double energy) const;
+
+  private:
+    /// Sample a new direction from the (1 + cos^2) Rayleigh phase function.
+    G4ThreeVector SampleRayleighDirection(const G4ThreeVector& direction) const;
+
+    G4bool fConfigured;
+    WaterTankOpticalGeometry fGeometry;
+    WaterTankPropertyTable   fAbsorptionLength;
+    WaterTankPropertyTable   fRayleighLength;
+    /// Group velocity if the water table provides it, otherwise unused.
+    WaterTankPropertyTable   fGroupVelocity;
+    /// Refractive index, used for c/n when GROUPVEL is unavailable.
+    WaterTankPropertyTable   fRefractiveIndex;
+    /// DOM surface reflectivity; as in G4OpBoundaryProcess a missing table
+    /// means full reflection.
+    WaterTankPropertyTable   fDOMReflectivity;
+    /// Safety cap on scatters per photon so pathological tables cannot hang.
+    G4int fMaxInteractions;
+};
+
+#endif
@@ -0,0 +1,88 @@
+/// \file WaterTankPropertyTable.hh
+/// \brief Definition of the WaterTankPropertyTable class
+
+#ifndef WaterTankPropertyTable_h
+#define WaterTankPropertyTable_h 1
+
+#include "globals.hh"
+
+#include <algorithm>
+#include <vector>
+
+class G4PhysicsVector;
+
+/// Flat, energy-indexed copy of a material property vector.
+///
+/// Optical property curves (efficiency, absorption length, ...) are resolved
+/// once from their G4MaterialPropertyVector and copied into contiguous node
+/// arrays plus a uniform cell-to-node index. Evaluation is then a clamp, one
+/// table read, one comparison and the same linear interpolation arithmetic as
+/// G4PhysicsVector::Value, so results are bit-identical to querying the
+/// original vector while the lookup itself only uses selects, never a search.
+
+class WaterTankPropertyTable
+{
+  public:
+    WaterTankPropertyTable();
+    ~WaterTankPropertyTable();
+
+    /// Copy the nodes of a (non-spline) property vector and build the index.
+    void Build(const G4PhysicsVector& vector);
+    /// Forget the tabulated curve; IsValid() returns false afterwards.
+    void Clear();
+
+    G4bool IsValid() const { return !fNodes.empty(); }
+
+    /// Interpolated property value, identical to G4PhysicsVector::Value(e).
+    inline G4double Value(G4double energy) const;
+
+    G4double GetMinEnergy() const { return fMinEnergy; }
+    G4double GetMaxEnergy() const { return fMaxEnergy; }
+    /// Largest tabulated value (e.g. peak quantum efficiency).
+    G4double GetMaxValue() const { return fMaxValue; }
+
+  private:
+    /// One interpolation interval, stored together for cache locality.
+    struct Node {
+      G4double energy;      ///< Lower edge of the interval
+      G4double deltaEnergy; ///< Interval width in energy
+      G4double value;       ///< Property value at the lower edge
+      G4double deltaValue;  ///< Value change across the interval
+    };
+
+    /// Interpolation intervals, one per pair of adjacent nodes.
+    std::vector<Node>        fNodes;
+    /// Node energies including the last one, for the bin correction step.
+    std::vector<G4double>    fEnergies;
+    /// Uniform cell -> index of the last node strictly below the cell.
+    std::vector<std::size_t> fCellToNode;
+    G4double fMinEnergy;
+    G4double fMaxEnergy;
+    G4double fFirstValue;
+    G4double fLastValue;
+    G4double fMaxValue;
+    /// Inverse width of the uniform index cells.
+    G4double fInvCellWidth;
+};
+
+inline G4double WaterTankPropertyTable::Value(G4double energy) const
+{
+  const G4double e = std::min(std::max(energy, fMinEnergy), fMaxEnergy);
+  const std::size_t cell = std::min(
+    static_cast<std::size_t>((e - fMinEnergy) * fInvCellWidth), fCellToNode.size() - 1);
+
+  // A cell is narrower than any node spacing, so at most one node can sit
+  // inside it; step over that node if the energy lies above it.
+  std::size_t idx = fCellToNode[cell];
+  idx += static_cast<std::size_t>(e > fEnergies[idx + 1]);
+
+  const Node& node = fNodes[idx];
+  const G4double b = (e - node.energy) / node.deltaEnergy;
+  const G4double res = node.value + b * node.deltaValue;
+
+  // G4PhysicsVector returns the edge values verbatim outside the open range.
+  return (energy <= fMinEnergy) ? fFirstValue
+       : (energy >= fMaxEnergy) ? fLastValue : res;
+}
+
+#endif
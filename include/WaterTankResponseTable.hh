@@ -0,0 +1,107 @@
+/// \file WaterTankResponseTable.hh
+/// \brief Definition of the WaterTankResponseTable class
+
+#ifndef WaterTankResponseTable_h
+#define WaterTankResponseTable_h 1
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <cstdint>
+#include <vector>
+
+/// Precomputed DOM response to single optical photons ("photonics" table).
+///
+/// The tank is symmetric around its axis and the DOM sits on that axis, so the
+/// response to a photon only depends on the emission radius r and height z,
+/// on the photon direction (cos of its polar angle, and azimuth phi measured
+/// from the outward radial direction, folded into [0, pi]) and on its energy.
+/// For each cell the table stores the probability that the photon reaches the
+/// DOM surface and, per direction cell, the cumulative distribution of its
+/// arrival delay. The DOM efficiency is not included; it is applied at lookup
+/// time by the DOM sensitive detector so QE settings stay in one place.
+///
+/// Tables are produced by the buildResponseTable tool and stored as a small
+/// fixed header followed by two float arrays in Geant4 internal units. Loading
+/// maps the file into memory, so worker threads that open the same table share
+/// its pages.
+
+class WaterTankResponseTable
+{
+  public:
+    /// Bin counts and ranges of the table axes.
+    struct Binning {
+      G4int    nR, nZ, nCos, nPhi, nEnergy, nTime;
+      G4double rMax;
+      G4double zMin, zMax;
+      G4double energyMin, energyMax;
+      G4double timeMax;
+    };
+
+    WaterTankResponseTable();
+    ~WaterTankResponseTable();
+
+    WaterTankResponseTable(const WaterTankResponseTable&) = delete;
+    WaterTankResponseTable& operator=(const WaterTankResponseTable&) = delete;
+
+    /// Create an empty in-memory table to be filled by the builder.
+    void Allocate(const Binning& binning, G4double domCenterZ, G4double domRadius,
+                  G4long photonsPerCell);
+    /// Write an allocated table to disk. Returns false on I/O errors.
+    G4bool Write(const G4String& fileName) const;
+    /// Map a table file produced by Write(). Returns false (with a warning)
+    /// if the file is missing or malformed; the previous table is released.
+    G4bool Load(const G4String& fileName);
+    /// Release the table.
+    void Clear();
+
+    G4bool IsValid() const { return fArrival != nullptr; }
+    const Binning& GetBinning() const { return fBinning; }
+    G4double GetDOMCenterZ() const { return fDOMCenterZ; }
+    G4double GetDOMRadius() const { return fDOMRadius; }
+    const G4String& GetFileName() const { return fFileName; }
+
+    /// Probability that a photon emitted at `position` along `direction`
+    /// reaches the DOM surface (nearest-cell lookup).
+    G4double GetArrivalProbability(const G4ThreeVector& position,
+                                   const G4ThreeVector& direction,
+                                   G4double energy) const;
+    /// Sample the delay between emission and arrival at the DOM.
+    G4double SampleArrivalDelay(const G4ThreeVector& position,
+                                const G4ThreeVector& direction) const;
+
+    /// Flat index of a direction cell, as used by the builder.
+    std::size_t DirectionCell(G4int iR, G4int iZ, G4int iCos, G4int iPhi) const
+    { return ((std::size_t(iR)*fBinning.nZ + iZ)*fBinning.nCos + iCos)*fBinning.nPhi + iPhi; }
+    /// Arrival probabilities (nEnergy values) of an allocated direction cell.
+    float* ArrivalOf(std::size_t cell) { return fStorage.data() + cell*fBinning.nEnergy; }
+    /// Arrival delay CDF (nTime values) of an allocated direction cell.
+    float* TimeCDFOf(std::size_t cell)
+    { return fStorage.data() + NumberOfDirectionCells()*fBinning.nEnergy + cell*fBinning.nTime; }
+
+    std::size_t NumberOfDirectionCells() const
+    { return std::size_t(fBinning.nR)*fBinning.nZ*fBinning.nCos*fBinning.nPhi; }
+
+  private:
+    /// Direction cell containing an emission point and direction.
+    std::size_t FindDirectionCell(const G4ThreeVector& position,
+                                  const G4ThreeVector& direction) const;
+    void Unmap();
+
+    Binning     fBinning;
+    G4double    fDOMCenterZ;
+    G4double    fDOMRadius;
+    G4long      fPhotonsPerCell;
+    G4String    fFileName;
+
+    /// Arrival probabilities followed by the delay CDFs, in file order.
+    const float* fArrival;
+    const float* fTimeCDF;
+
+    /// Backing memory: a file mapping when loaded, fStorage when allocated.
+    void*        fMapping;
+    std::size_t  fMappingSize;
+    std::vector<float> fStorage;
+};
+
+#endif
@@ -4,18 +4,25 @@
 #ifndef WaterTankRunAction_h
 #define WaterTankRunAction_h 1
 
+#include "WaterTankNtupleOutput.hh"
+
 #include "G4UserRunAction.hh"
 #include "G4Accumulable.hh"
 #include "globals.hh"
 
+#include <vector>
+
 class G4Run;
+class WaterTankRunMessenger;
 
 /// Collects run-wide observables and manages persistent output.
 ///
 /// The run action owns Geant4 accumulables that receive energy deposition
 /// contributions from the stepping action. It opens the ROOT output file,
 /// defines ntuples for event and DOM hit summaries, and at the end of the run
-/// computes statistics before writing results to disk.
+/// computes statistics before writing results to disk. The ntuples are booked
+/// at the start of the first run so that /watertank/output/ commands in the
+/// macro can still shape them.
 
 class WaterTankRunAction : public G4UserRunAction
 {
@@ -27,14 +34,213 @@ class WaterTankRunAction : public G4UserRunAction
   virtual void BeginOfRunAction(const G4Run*);
   virtual void   EndOfRunAction(const G4Run*);
 
+  /// How much is written per event. Each level includes the ones below:
+  /// the "event" summary, then the per-DOM "domdigi" readout, then one
+  /// "domhits" row per detected photon.
+  enum OutputLevel { kSummaryOutput = 0, kDigitizedOutput, kFullOutput };
+  /// Select the output level; applies from the next run on.
+  void SetOutputLevel(OutputLevel level) { fOutputLevel = level; }
+  OutputLevel GetOutputLevel() const { return fOutputLevel; }
+
+  /// Merge the worker ntuples into one file through the master (default),
+  /// or let each worker thread write its own file with a "_t<N>" suffix
+  /// (e.g. output_default_t0.root). Only takes effect before the ntuples
+  /// are booked.
+  void SetNtupleMerging(G4bool merge);
+  G4bool GetNtupleMerging() const { return fNtupleMerging; }
+
+  /// Write the ntuples to ROOT (default), to the columnar format (.wtc, see
+  /// WaterTankColumnarReader.hh) or to both. Columnar files are written per
+  /// thread, so they turn ntuple merging off. Only takes effect before the
+  /// ntuples are booked.
+  void SetOutputFormat(WaterTankNtupleOutput::Format format);
+  /// Booking and filling of the ntuples in the selected formats.
+  WaterTankNtupleOutput& GetNtupleOutput() { return fNtupleOutput; }
+
+  /// Write each thread's columnar ntuple rows on a writer thread of its own,
+  /// which may fall up to `events` events behind before the event loop waits
+  /// for it (0, the default, writes synchronously). ROOT rows stay on the
+  /// event-loop thread. Only takes effect before the ntuples are booked.
+  void SetAsyncOutput(G4int events);
+  G4int GetAsyncOutput() const { return fAsyncOutputEvents; }
+
+  /// Append the run number to the output file name ("_run<N>") so that
+  /// successive runs do not overwrite each other.
+  void SetRunNumbering(G4bool numbering) { fRunNumbering = numbering; }
+  /// Close the output file and continue in a new chunk ("_c<K>") after
+  /// `events` events and/or once the file reaches `megabytes` on disk (0
+  /// disables either limit). Rollover needs rows written as they are filled:
+  /// sequential runs, or worker files with ntuple merging off.
+  void SetRolloverEvents(G4int events) { fRolloverEvents = events; }
+  void SetRolloverSize(G4double megabytes) { fRolloverMegabytes = megabytes; }
+
+  /// Called by the event action before an event; starts the next chunk
+  /// when the previous event filled the current one.
+  void BeginEventOutput();
+  /// Called by the event action once the event's rows are filled.
+  void EndEventOutput(G4int eventID);
+
+  /// Store the domhits payload as one row per event with vector columns
+  /// (default) or, for older analyses, as one row per photon. Only takes
+  /// effect before the ntuples are booked.
+  void SetVectorHitLayout(G4bool vectorLayout);
+  G4bool IsVectorHitLayout() const { return fVectorHitLayout; }
+
+  /// Per-event hit vectors bound to the domhits columns in vector layout.
+  /// The event action fills them before adding the event's row.
+  struct HitColumns
+  {
+    std::vector<G4int> trackID;
+    std::vector<G4int> parentID;
+    /// Offsets from the event's TimeReference_ns.
+    std::vector<float> time;
+    std::vector<float> energy;
+    std::vector<float> wavelength;
+    std::vector<float> posX;
+    std::vector<float> posY;
+    std::vector<float> posZ;
+    std::vector<float> dirX;
+    std::vector<float> dirY;
+    std::vector<float> dirZ;
+    std::vector<float> weight;
+    /// Fixed-point replacements used when a column group is quantized;
+    /// timeTicks are offsets from TimeReference_ns too.
+    std::vector<G4int> timeTicks;
+    std::vector<G4int> energyTicks;
+    std::vector<G4int> posXTicks;
+    std::vector<G4int> posYTicks;
+    std::vector<G4int> posZTicks;
+    std::vector<G4int> dirOctahedral;
+  };
+  HitColumns& GetHitColumns() { return fHitColumns; }
+
+  /// Per-DOM vectors bound to the domdigi columns: the sampled waveform (PE
+  /// per sample, empty unless stored) and the extracted pulses, timed from
+  /// the window start.
+  struct DigiColumns
+  {
+    std::vector<float> waveform;
+    std::vector<float> pulseTime;
+    std::vector<float> pulseCharge;
+  };
+  DigiColumns& GetDigiColumns() { return fDigiColumns; }
+
+  /// Precision of the vector-layout domhits column groups. A step of zero
+  /// keeps the float column; a positive step stores the nearest integer
+  /// number of steps instead (in ns, eV and cm). Octahedral directions pack
+  /// each direction into one int (see WaterTankOutputEncoding.hh).
+  struct HitPrecision
+  {
+    G4double timeStep = 0.;
+    G4double energyStep = 0.;
+    G4double positionStep = 0.;
+    G4bool   octahedralDirections = false;
+  };
+  /// Only takes effect before the ntuples are booked.
+  void SetHitPrecision(const HitPrecision& precision);
+  const HitPrecision& GetHitPrecision() const { return fHitPrecision; }
+
+  /// Fractions whose hit-time quantiles get their own event columns. Only
+  /// takes effect before the ntuples are booked.
+  void SetTimeQuantiles(const std::vector<G4double>& fractions);
+  const std::vector<G4double>& GetTimeQuantiles() const { return fTimeQuantiles; }
+  /// Column of the event ntuple holding the first time quantile.
+  static constexpr G4int kFirstQuantileColumn = 19;
+
   /// Thread-safe way to accumulate deposited energy.
   void AddEdep (G4double edep);
+  /// Count an optical photon examined by the stacking action's culling.
+  void AddCullingCandidate() { fCullCandidates += 1; }
+  /// Record the culling roulette of a photon of weight `weight`, whose
+  /// weight becomes `newWeight` (zero if it was killed).
+  void AddCullRoulette(G4double weight, G4double newWeight)
+  {
+    if (newWeight > 0.) fCullWeightAdded += newWeight - weight;
+    else {
+      fCulledPhotons += 1;
+      fCullWeightKilled += weight;
+    }
+  }
+  /// Record one Russian roulette of an optical photon of weight `weight`,
+  /// whose weight becomes `newWeight` (zero if it was killed).
+  void AddRoulette(G4double weight, G4double newWeight)
+  {
+    fRouletteTrials += 1;
+    if (newWeight > 0.) fRouletteWeightAdded += newWeight - weight;
+    else {
+      fRouletteKilled += 1;
+      fRouletteWeightKilled += weight;
+    }
+  }
 
   private:
+  /// Create the event and DOM hit ntuples.
+  void BookNtuples();
+  /// True where rows go to this thread's own file as they are filled.
+  G4bool WritesRowsDirectly() const;
+  G4bool RollsOver() const;
+  /// Open the current chunk, and close it and write its manifest.
+  void OpenChunk();
+  void CloseChunk();
+  /// Write <file>.manifest, a small JSON record of a closed output file.
+  void WriteManifest() const;
+
+  WaterTankRunMessenger* fMessenger;
+  G4bool fNtuplesBooked;
+  G4bool fNtupleMerging;
+  WaterTankNtupleOutput fNtupleOutput;
+  G4int fAsyncOutputEvents;
+  OutputLevel fOutputLevel;
+  G4bool fVectorHitLayout;
+  HitColumns fHitColumns;
+  DigiColumns fDigiColumns;
+  HitPrecision fHitPrecision;
+  std::vector<G4double> fTimeQuantiles;
+  /// Output naming and rollover settings.
+  G4bool   fRunNumbering;
+  G4int    fRolloverEvents;
+  G4double fRolloverMegabytes;
+  /// Name before run and chunk suffixes, and the names of the open chunk as
+  /// passed to the analysis manager and as written (with any thread suffix):
+  /// the ROOT file, or the columnar one for columnar-only output, and the
+  /// columnar file next to a ROOT one.
+  G4String fBaseFileName;
+  G4String fOpenedFileName;
+  G4String fWrittenFileName;
+  G4String fWrittenColumnarName;
+  /// Current run and chunk, and the events written to the chunk so far.
+  G4int    fRunID;
+  G4int    fChunk;
+  G4int    fChunkEvents;
+  G4int    fChunkFirstEvent;
+  G4int    fChunkLastEvent;
+  G4bool   fRolloverDue;
   /// Sum of deposited energy across the run (uses Geant4 accumulables).
   G4Accumulable<G4double> fEdep;
   /// Sum of squared deposited energy to compute RMS.
   G4Accumulable<G4double> fEdep2;
+  /// Optical photons born in the water while culling was enabled.
+  G4Accumulable<G4long>   fCullCandidates;
+  /// Optical photons killed at birth by the stacking action.
+  G4Accumulable<G4long>   fCulledPhotons;
+  /// Weight removed with culled photons and weight given to the survivors of
+  /// the culling roulette; they agree on average.
+  G4Accumulable<G4double> fCullWeightKilled;
+  G4Accumulable<G4double> fCullWeightAdded;
+  /// Russian roulettes played on optical photons and how many were lost.
+  G4Accumulable<G4long>   fRouletteTrials;
+  G4Accumulable<G4long>   fRouletteKilled;
+  /// Weight removed with killed photons and weight given to survivors; they
+  /// agree on average, which is what keeps the roulette unbiased.
+  G4Accumulable<G4double> fRouletteWeightKilled;
+  G4Accumulable<G4double> fRouletteWeightAdded;
+  /// Events queued for the output writer threads, the summed queue depth
+  /// they found, the deepest queue, and the waits on a full queue.
+  G4Accumulable<G4long>   fOutputEvents;
+  G4Accumulable<G4double> fOutputDepthSum;
+  G4Accumulable<G4int>    fOutputMaxDepth;
+  G4Accumulable<G4long>   fOutputStalls;
+  G4Accumulable<G4double> fOutputStallSeconds;
   /// Histogram bin width (kept for potential calorimeter maps).
   G4float m_segment;
 };
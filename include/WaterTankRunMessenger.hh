@@ -0,0 +1,52 @@
+/// \file WaterTankRunMessenger.hh
+/// \brief Definition of the WaterTankRunMessenger class
+
+#ifndef WaterTankRunMessenger_h
+#define WaterTankRunMessenger_h 1
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class WaterTankRunAction;
+class G4UIdirectory;
+class G4UIcmdWithAString;
+class G4UIcmdWithABool;
+class G4UIcmdWithADouble;
+class G4UIcmdWithAnInteger;
+class G4UIcommand;
+
+/// Messenger class for WaterTankRunAction
+///
+/// This class provides UI commands under /watertank/output/ that shape the
+/// ntuples written by the run action: the output level and the file naming
+/// and rollover, which can change between runs, and the format, the merging,
+/// the asynchronous writing, the time quantile columns and the domhits layout
+/// and precision, which are fixed once the ntuples are booked at the start of
+/// the first run.
+
+class WaterTankRunMessenger : public G4UImessenger
+{
+  public:
+    WaterTankRunMessenger(WaterTankRunAction* runAction);
+    virtual ~WaterTankRunMessenger();
+
+    virtual void SetNewValue(G4UIcommand* command, G4String newValue);
+
+  private:
+    WaterTankRunAction* fRunAction;
+
+    G4UIdirectory* fOutputDirectory;
+    G4UIcmdWithAString* fTimeQuantilesCmd;
+    G4UIcmdWithAString* fLevelCmd;
+    G4UIcmdWithABool* fHitRowsCmd;
+    G4UIcmdWithABool* fMergeCmd;
+    G4UIcmdWithAString* fFormatCmd;
+    G4UIcmdWithAnInteger* fAsyncCmd;
+    G4UIcmdWithABool* fRunNumberingCmd;
+    G4UIcmdWithAnInteger* fRolloverEventsCmd;
+    G4UIcmdWithADouble* fRolloverSizeCmd;
+    G4UIcommand* fPrecisionCmd;
+    G4UIcmdWithABool* fOctahedralCmd;
+};
+
+#endif
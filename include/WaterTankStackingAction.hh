@@ -0,0 +1,148 @@
+/// \file WaterTankStackingAction.hh
+/// \brief Definition of the WaterTankStackingAction class
+
+#ifndef WaterTankStackingAction_h
+#define WaterTankStackingAction_h 1
+
+#include "G4UserStackingAction.hh"
+#include "globals.hh"
+
+#include "WaterTankOpticalGeometry.hh"
+#include "WaterTankPropertyTable.hh"
+#include "WaterTankPhotonPropagator.hh"
+#include "WaterTankResponseTable.hh"
+
+class WaterTankRunAction;
+class WaterTankStackingMessenger;
+class WaterTankDOMSD;
+
+/// Decides at birth which optical photons are worth tracking.
+///
+/// By default every track is stacked as usual. With photon culling enabled
+/// (/watertank/optics/cullPhotons) a Cherenkov photon whose straight path
+/// misses the DOM can only be detected after Rayleigh scattering back towards
+/// it. We estimate that probability from the scattering length along the path
+/// to the tank wall, the DOM solid angle seen from the birth point, and
+/// absorption over that distance. Photons below the configured threshold play
+/// Russian roulette: they survive with a chance proportional to the estimate
+/// (at least 1 %) and survivors carry the inverse of that chance as weight,
+/// so the expected DOM hits are unbiased. The killed weight and the weight
+/// given to survivors are reported to the run action, where they should
+/// agree within statistics.
+///
+/// In QE-first mode (/watertank/optics/qeFirst) every new optical photon is
+/// kept with probability QEmax, the peak of the DOM efficiency curve, which is
+/// equivalent to scaling the Cherenkov yield by QEmax. The DOM sensitive
+/// detector is switched to sample only QE(E)/QEmax, so hit distributions are
+/// unchanged while roughly 1/QEmax fewer photons are tracked.
+///
+/// With analytic propagation (/watertank/optics/analyticPropagation) photons
+/// born in the water are not stacked at all. WaterTankPhotonPropagator traces
+/// them to the DOM, the DOM sensitive detector applies its efficiency and
+/// records the hit, and the track is killed. Reflections off the DOM follow
+/// the surface reflectivity, so results match full tracking of this geometry.
+///
+/// With photon bundles (/watertank/optics/bundleSize N) only one optical
+/// photon in N is kept, at random, and given weight N. Hits inherit the
+/// weight, so DOM hit counts stay unbiased while N times fewer photons are
+/// tracked, at the price of coarser statistical granularity.
+///
+/// In table-lookup mode (/watertank/optics/tableLookup) a precomputed
+/// WaterTankResponseTable replaces photon transport entirely: the stepping
+/// action converts the Cherenkov emission of each charged step in the water
+/// into DOM hits. G4Cerenkov is told not to stack its photons while the mode
+/// is active, so none are created, in the water or (a small contribution the
+/// table does not describe) in the DOM glass; optical photons that still
+/// appear in the water are killed here. QE-first does not apply in this
+/// mode, since the table hits already carry the full DOM efficiency.
+///
+/// The readout window (/watertank/optics/timeWindow) is handed to the DOM
+/// sensitive detector before each event. Photons born after it has closed
+/// are killed here.
+
+class WaterTankStackingAction : public G4UserStackingAction
+{
+  public:
+    WaterTankStackingAction(WaterTankRunAction* runAction);
+    virtual ~WaterTankStackingAction();
+
+    virtual G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track* track);
+    virtual void PrepareNewEvent();
+
+    /// Enable or disable geometric culling of optical photons at birth.
+    void SetCullPhotons(G4bool cull) { fCullPhotons = cull; }
+    /// Scatter-in probability below which photons missing the DOM are culled.
+    void SetCullThreshold(G4double threshold) { fCullThreshold = threshold; }
+    /// Enable or disable pre-applying the peak DOM efficiency at emission.
+    void SetQEFirst(G4bool qeFirst) { fQEFirst = qeFirst; }
+    /// Enable or disable analytic transport of optical photons in water.
+    void SetAnalyticPropagation(G4bool analytic) { fAnalyticPropagation = analytic; }
+    /// Number of physical photons carried by each tracked optical photon.
+    void SetBundleSize(G4int size) { fBundleSize = size; }
+    /// Readout window after the first charged particle enters the water;
+    /// optical photons and hits beyond it are dropped. Zero disables it.
+    void SetTimeWindow(G4double window) { fTimeWindow = window; }
+    G4double GetTimeWindow() const { return fTimeWindow; }
+    /// Russian roulette for long photon histories: every fRouletteInterval
+    /// scatters or boundary interactions a photon survives with probability
+    /// fRouletteSurvival and has its weight divided by it. Zero disables it.
+    void SetRouletteInterval(G4int interactions) { fRouletteInterval = interactions; }
+    G4int GetRouletteInterval() const { return fRouletteInterval; }
+    void SetRouletteSurvival(G4double probability) { fRouletteSurvival = probability; }
+    G4double GetRouletteSurvival() const { return fRouletteSurvival; }
+    /// Map a DOM response table file for table-lookup mode.
+    void LoadResponseTable(const G4String& fileName) { fResponseTable.Load(fileName); }
+    /// Enable or disable table-lookup mode.
+    void SetTableLookup(G4bool lookup) { fTableLookup = lookup; }
+    /// Response table to sample hits from, or nullptr if table lookup is off
+    /// or no valid table has been loaded.
+    const WaterTankResponseTable* GetActiveResponseTable() const
+    { return (fTableLookup && fResponseTable.IsValid()) ? &fResponseTable : nullptr; }
+
+  private:
+    /// Lazily read geometry and water optical tables on the worker thread.
+    void Configure();
+    /// Estimated probability that a photon whose direct path misses the DOM
+    /// still reaches it after scattering.
+    G4double ScatterInProbability(const G4Track* track) const;
+    /// Trace a new photon to the DOM and record a hit if it is detected.
+    void PropagateAnalytically(const G4Track* track);
+    /// Switch photon stacking of this thread's Cerenkov processes.
+    void SetCerenkovStacking(G4bool stack);
+
+    /// Run action that accumulates the per-run culling statistics.
+    WaterTankRunAction* fRunAction;
+    /// UI commands under /watertank/optics/.
+    WaterTankStackingMessenger* fMessenger;
+
+    G4bool   fCullPhotons;
+    G4double fCullThreshold;
+    G4bool   fQEFirst;
+    G4bool   fAnalyticPropagation;
+    G4bool   fTableLookup;
+    G4int    fBundleSize;
+    G4double fTimeWindow;
+    G4int    fRouletteInterval;
+    G4double fRouletteSurvival;
+    /// Survival probability applied at birth in QE-first mode (peak DOM QE).
+    G4double fEmissionQE;
+    /// Whether this thread's Cerenkov processes stack photons; only changed
+    /// from the physics list setting while table lookup is active.
+    G4bool   fCerenkovStacking;
+
+    /// This thread's DOM sensitive detector, kept in step with fQEFirst.
+    WaterTankDOMSD* fDOMSD;
+
+    /// Tank and DOM shapes used for straight-line photon tests.
+    WaterTankOpticalGeometry fGeometry;
+    /// Water absorption length vs. photon energy.
+    WaterTankPropertyTable   fAbsorptionLength;
+    /// Water Rayleigh scattering length vs. photon energy.
+    WaterTankPropertyTable   fRayleighLength;
+    /// Ray tracer used when analytic propagation is enabled.
+    WaterTankPhotonPropagator fPropagator;
+    /// Precomputed DOM response used in table-lookup mode.
+    WaterTankResponseTable    fResponseTable;
+};
+
+#endif
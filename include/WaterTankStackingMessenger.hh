@@ -0,0 +1,56 @@
+/// \file WaterTankStackingMessenger.hh
+/// \brief Definition of the WaterTankStackingMessenger class
+
+#ifndef WaterTankStackingMessenger_h
+#define WaterTankStackingMessenger_h 1
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class WaterTankStackingAction;
+class G4UIdirectory;
+class G4UIcmdWithABool;
+class G4UIcmdWithADouble;
+class G4UIcmdWithAString;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithADoubleAndUnit;
+
+/// Messenger class for WaterTankStackingAction
+///
+/// This class provides UI commands under /watertank/optics/ that control how
+/// optical photons are treated when they are created:
+/// - Enable geometric culling of photons that cannot reach the DOM
+/// - Set the scatter-in probability threshold used by the culling
+/// - Pre-apply the peak DOM quantum efficiency at emission (QE-first mode)
+/// - Replace Geant4 tracking of photons in water by analytic ray tracing
+/// - Load a precomputed DOM response table and switch to table lookup
+/// - Bundle several physical photons into one weighted optical track
+/// - Set the readout window beyond which optical photons are killed
+/// - Play Russian roulette with optical photons after many interactions
+
+class WaterTankStackingMessenger : public G4UImessenger
+{
+  public:
+    WaterTankStackingMessenger(WaterTankStackingAction* stackingAction);
+    virtual ~WaterTankStackingMessenger();
+
+    virtual void SetNewValue(G4UIcommand* command, G4String newValue);
+
+  private:
+    WaterTankStackingAction* fStackingAction;
+
+    G4UIdirectory* fOpticsDirectory;
+
+    G4UIcmdWithABool* fCullPhotonsCmd;
+    G4UIcmdWithADouble* fCullThresholdCmd;
+    G4UIcmdWithABool* fQEFirstCmd;
+    G4UIcmdWithABool* fAnalyticPropagationCmd;
+    G4UIcmdWithAString* fResponseTableCmd;
+    G4UIcmdWithABool* fTableLookupCmd;
+    G4UIcmdWithAnInteger* fBundleSizeCmd;
+    G4UIcmdWithADoubleAndUnit* fTimeWindowCmd;
+    G4UIcmdWithAnInteger* fRouletteIntervalCmd;
+    G4UIcmdWithADouble* fRouletteSurvivalCmd;
+};
+
+#endif
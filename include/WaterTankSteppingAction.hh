@@ -7,31 +7,79 @@
 #include "G4UserSteppingAction.hh"
 #include "globals.hh"
 
+#include "WaterTankPropertyTable.hh"
+
 class WaterTankEventAction;
+class WaterTankRunAction;
+class WaterTankStackingAction;
+class WaterTankResponseTable;
+class WaterTankDOMSD;
 
 class G4LogicalVolume;
+class G4VPhysicalVolume;
 
 /// Collects step-level energy deposition inside the scoring volume.
 ///
 /// Every step, the action checks whether we are inside the water volume used
 /// for calorimetry. Non-optical tracks contribute their deposited energy to the
 /// event action, while optical photons are ignored to avoid double-counting
-/// energy carried by Cherenkov light.
+/// energy carried by Cherenkov light. Optical photon steps that leave the water
+/// through a geometry boundary are handed to the DOM sensitive detector, which
+/// decides whether the boundary was the DOM and records the hit.
+///
+/// When a readout window is set (/watertank/optics/timeWindow), optical
+/// photons are killed as soon as their time exceeds the first charged-particle
+/// entry into the water plus the window. The DOM sensitive detector keeps the
+/// entry time and counts them (see WaterTankDOMSD).
+///
+/// With Russian roulette enabled (/watertank/optics/rouletteInterval), the
+/// action counts Rayleigh/Mie scatters and boundary interactions of each
+/// photon. Every N of them the photon survives with the configured
+/// probability p and its weight is divided by p, so DOM hits stay unbiased
+/// while long histories are cut short. Statistics go to the run action.
+///
+/// In table-lookup mode, steps of charged particles in the water are turned
+/// into DOM hits directly: the mean Cherenkov yield of the step is computed
+/// from the water refractive index as G4Cerenkov does, a Poisson number of
+/// photons is sampled along the step and on the Cherenkov cone, and each one
+/// is detected with the tabulated arrival probability times the DOM
+/// efficiency, at the tabulated arrival delay.
 
 class WaterTankSteppingAction : public G4UserSteppingAction
 {
   public:
-    WaterTankSteppingAction(WaterTankEventAction* eventAction);
+    WaterTankSteppingAction(WaterTankRunAction* runAction,
+                            WaterTankEventAction* eventAction,
+                            WaterTankStackingAction* stackingAction);
     virtual ~WaterTankSteppingAction();
 
     // method from the base class
     virtual void UserSteppingAction(const G4Step*);
 
   private:
+    /// Sample DOM hits for the Cherenkov emission of a charged step.
+    void GenerateTableHits(const G4Step* step, const WaterTankResponseTable& table);
+    /// Count the photon's interactions and play Russian roulette when due.
+    void PlayRoulette(const G4Step* step);
+
     /// Event action that aggregates per-event energy totals.
     WaterTankEventAction*  fEventAction;
+    /// Run action collecting the roulette statistics.
+    WaterTankRunAction* fRunAction;
     /// Cached pointer to the water scoring volume for quick comparisons.
     G4LogicalVolume* fScoringVolume;
+    /// Cached water placement used to spot photon steps leaving the water.
+    const G4VPhysicalVolume* fWaterPhysicalVolume;
+    /// This thread's DOM sensitive detector, fed with boundary steps.
+    WaterTankDOMSD* fDOMSD;
+    /// Owner of the optical photon mode settings and the response table.
+    WaterTankStackingAction* fStackingAction;
+    /// Water refractive index, used for the Cherenkov yield and angle.
+    WaterTankPropertyTable fRefractiveIndex;
+    /// Scatters and boundary interactions of the photon being tracked. Tracks
+    /// are stepped one at a time, so a single counter reset at the first step
+    /// is enough.
+    G4int fPhotonInteractions;
 };
 
 #endif
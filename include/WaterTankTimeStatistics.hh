@@ -0,0 +1,84 @@
+/// \file WaterTankTimeStatistics.hh
+/// \brief Definition of the WaterTankTimeStatistics class
+
+#ifndef WaterTankTimeStatistics_h
+#define WaterTankTimeStatistics_h 1
+
+#include "globals.hh"
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/// Weighted summary statistics of the DOM hit times of one event.
+///
+/// Compute() reads the time and weight columns of the hit buffer and makes
+/// one pass for the weight sums, min, max and mean, and a second pass for
+/// the variance around that mean. Both are plain loops over contiguous
+/// arrays with no branches beyond min/max, so the compiler can vectorize
+/// them, and the variance does not suffer the cancellation of the
+/// sum-of-squares formula.
+///
+/// Quantiles (the median and any requested fractions) are found by
+/// selection with std::nth_element instead of a full sort. The fractions
+/// are processed in increasing order and each selection starts where the
+/// previous one ended, so extra quantiles cost much less than a sort. The
+/// weighted quantile q is the first time at which the cumulative weight
+/// reaches q times the total weight. If it lands exactly on that value, the
+/// result is averaged with the next time, which gives the usual median for
+/// an even number of equal weights.
+///
+/// The object keeps its scratch buffer between events; each worker thread
+/// uses its own instance through its event action.
+
+class WaterTankTimeStatistics
+{
+  public:
+    WaterTankTimeStatistics();
+
+    /// Statistics of n hits; `quantiles` lists the extra fractions in (0, 1)
+    /// to evaluate, in any order.
+    void Compute(const G4double* times, const float* weights, std::size_t n,
+                 const std::vector<G4double>& quantiles);
+
+    /// Total weight (the weighted hit count) and sum of squared weights.
+    G4double GetSumWeight() const { return fSumWeight; }
+    G4double GetSumWeight2() const { return fSumWeight2; }
+    G4double GetMin() const { return fMin; }
+    G4double GetMax() const { return fMax; }
+    G4double GetMean() const { return fMean; }
+    G4double GetRMS() const { return fRMS; }
+    G4double GetMedian() const { return fMedian; }
+    /// Quantile times in the order the fractions were passed to Compute().
+    const std::vector<G4double>& GetQuantiles() const { return fQuantiles; }
+
+  private:
+    struct TimedWeight
+    {
+      G4double time;
+      float weight;
+    };
+
+    /// Select the entry at which the cumulative weight reaches `target`,
+    /// searching from `lo` with `below` the weight of the entries before it.
+    /// Both are advanced to the selected entry for the next search.
+    std::size_t Select(G4double target, std::size_t& lo, G4double& below);
+    /// Quantile at cumulative weight `target`, including the averaging rule.
+    G4double Quantile(G4double target, std::size_t& lo, G4double& below);
+
+    G4double fSumWeight;
+    G4double fSumWeight2;
+    G4double fMin;
+    G4double fMax;
+    G4double fMean;
+    G4double fRMS;
+    G4double fMedian;
+    std::vector<G4double> fQuantiles;
+
+    /// Hit (time, weight) pairs reordered by the selections.
+    std::vector<TimedWeight> fScratch;
+    /// Requested fractions with their output slot, sorted by fraction.
+    std::vector<std::pair<G4double, G4int>> fOrder;
+};
+
+#endif
@@ -6,6 +6,7 @@
 #include "WaterTankRunAction.hh"
 #include "WaterTankEventAction.hh"
 #include "WaterTankSteppingAction.hh"
+#include "WaterTankStackingAction.hh"
 
 WaterTankActionInitialization::WaterTankActionInitialization()
  : G4VUserActionInitialization()
@@ -37,6 +38,13 @@ void WaterTankActionInitialization::Build() const
   WaterTankEventAction* eventAction = new WaterTankEventAction(runAction);
   SetUserAction(eventAction);
   
-  // The stepping action depends on the event action to stash energy deposits.
-  SetUserAction(new WaterTankSteppingAction(eventAction));
+  // The stacking action decides which optical photons get tracked and reports
+  // its bookkeeping to the run action.
+  WaterTankStackingAction* stackingAction = new WaterTankStackingAction(runAction);
+  SetUserAction(stackingAction);
+
+  // The stepping action depends on the event action to stash energy deposits,
+  // on the stacking action for the optical photon mode in use, and reports
+  // its roulette statistics to the run action.
+  SetUserAction(new WaterTankSteppingAction(runAction, eventAction, stackingAction));
 }
@@ -15,6 +15,7 @@ WaterTankCRYPrimaryGenerator::WaterTankCRYPrimaryGenerator()
 : G4VPrimaryGenerator(),
   fParticleGun(nullptr),
   fParticleTable(nullptr),
+  fCRYSetup(nullptr),
   fCRYGenerator(nullptr),
   fParticleVector(nullptr),
   fInitialized(false)
@@ -26,6 +27,7 @@ WaterTankCRYPrimaryGenerator::WaterTankCRYPrimaryGenerator(const G4String& setup
 : G4VPrimaryGenerator(),
   fParticleGun(nullptr),
   fParticleTable(nullptr),
+  fCRYSetup(nullptr),
   fCRYGenerator(nullptr),
   fParticleVector(nullptr),
   fInitialized(false)
@@ -37,7 +39,9 @@ WaterTankCRYPrimaryGenerator::WaterTankCRYPrimaryGenerator(const G4String& setup
 WaterTankCRYPrimaryGenerator::~WaterTankCRYPrimaryGenerator()
 {
   delete fParticleGun;
+  // The generator uses the setup's utilities, so it goes first.
   delete fCRYGenerator;
+  delete fCRYSetup;
   if (fParticleVector) {
     for (auto particle : *fParticleVector) {
       delete particle;
@@ -83,16 +87,27 @@ void WaterTankCRYPrimaryGenerator::SetupCRY(const G4String& setupFile)
 void WaterTankCRYPrimaryGenerator::SetupCRY(const G4String& setupString, const G4String& dataPath)
 {
   try {
-    // Create CRY setup
+    delete fCRYGenerator;
+    delete fCRYSetup;
+    fCRYGenerator = nullptr;
+    fInitialized = false;
+
+    // Create CRY setup; it only parses the setup string
     CRYSetup* setup = new CRYSetup(setupString, dataPath);
+    fCRYSetup = setup;
     
-    // Create CRY generator
+    // Create CRY generator. This reads the data table of the configured
+    // altitude, unless another setup (e.g. on another worker thread)
+    // already did; the table is then shared.
     fCRYGenerator = new CRYGenerator(setup);
+    // Time particles from the start of their event rather than on CRY's
+    // clock, which adds up all events generated on this thread.
+    fCRYGenerator->setEventRelativeTime(true);
     
-    // Set up random number generator
-    RNGWrapper<CLHEP::HepRandomEngine>::set(CLHEP::HepRandom::getTheEngine(), 
-                                            &CLHEP::HepRandomEngine::flat);
-    setup->setRandomFunction(RNGWrapper<CLHEP::HepRandomEngine>::rng);
+    // Draw CRY's random numbers from this thread's engine. Geant4 gives
+    // each worker its own engine and reseeds it for every event.
+    CLHEP::HepRandomEngine* engine = G4Random::getTheEngine();
+    setup->setRandomFunction([engine]() { return engine->flat(); });
     
     fInitialized = true;
     
@@ -159,7 +174,8 @@ void WaterTankCRYPrimaryGenerator::GeneratePrimaryVertex(G4Event* anEvent)
     fParticleGun->SetParticleMomentumDirection(G4ThreeVector(cryParticle->u(), 
                                                              cryParticle->v(), 
                                                              cryParticle->w()));
-  // CRY returns time in seconds; convert to Geant4 internal units
+  // CRY returns the time since the start of the event in seconds; convert
+  // to Geant4 internal units
   fParticleGun->SetParticleTime(cryParticle->t() * s);
     
     // Generate primary vertex
@@ -0,0 +1,270 @@
+/// \file WaterTankColumnarWriter.cc
+/// \brief Implementation of the WaterTankColumnarWriter class
+
+#include "WaterTankColumnarWriter.hh"
+#include "WaterTankColumnarReader.hh"
+
+#include <chrono>
+
+WaterTankColumnarWriter::WaterTankColumnarWriter()
+: fFile(nullptr),
+  fOffset(0),
+  fWriteError(false),
+  fStop(false),
+  fStallSeconds(0.)
+{}
+
+WaterTankColumnarWriter::~WaterTankColumnarWriter()
+{
+  CloseFile();
+}
+
+G4int WaterTankColumnarWriter::CreateNtuple(const G4String& name, const G4String& title)
+{
+  fTables.emplace_back();
+  fTables.back().name = name;
+  fTables.back().title = title;
+  return G4int(fTables.size()) - 1;
+}
+
+G4int WaterTankColumnarWriter::AddColumn(const G4String& name, std::uint8_t type,
+                                         const std::vector<G4int>* intVector,
+                                         const std::vector<float>* floatVector)
+{
+  Table& table = fTables.back();
+  table.columns.push_back({name, type, intVector, floatVector});
+  table.staged.push_back(Value());
+  table.staged.back().d = 0.;
+  for (auto& buffer : table.buffers) {
+    buffer.data.resize(table.columns.size());
+    buffer.lengths.resize(table.columns.size());
+  }
+  return G4int(table.columns.size()) - 1;
+}
+
+G4int WaterTankColumnarWriter::CreateNtupleIColumn(const G4String& name)
+{
+  return AddColumn(name, WaterTankColumnar::kInt);
+}
+
+G4int WaterTankColumnarWriter::CreateNtupleFColumn(const G4String& name)
+{
+  return AddColumn(name, WaterTankColumnar::kFloat);
+}
+
+G4int WaterTankColumnarWriter::CreateNtupleDColumn(const G4String& name)
+{
+  return AddColumn(name, WaterTankColumnar::kDouble);
+}
+
+G4int WaterTankColumnarWriter::CreateNtupleIColumn(const G4String& name, std::vector<G4int>& vector)
+{
+  return AddColumn(name, WaterTankColumnar::kInt, &vector);
+}
+
+G4int WaterTankColumnarWriter::CreateNtupleFColumn(const G4String& name, std::vector<float>& vector)
+{
+  return AddColumn(name, WaterTankColumnar::kFloat, nullptr, &vector);
+}
+
+G4bool WaterTankColumnarWriter::OpenFile(const G4String& fileName)
+{
+  CloseFile();
+  if (!WaterTankColumnar::IsLittleEndianHost()) {
+    G4Exception("WaterTankColumnarWriter::OpenFile()", "ColumnarOutput001", JustWarning,
+                "The columnar format is little-endian; it is not written on this host.");
+    return false;
+  }
+  fFile = std::fopen(fileName.c_str(), "wb");
+  if (!fFile) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open " << fileName << " for writing; no columnar output.";
+    G4Exception("WaterTankColumnarWriter::OpenFile()", "ColumnarOutput001", JustWarning, msg);
+    return false;
+  }
+  // Large stdio buffer: blocks are written in a few big calls.
+  std::setvbuf(fFile, nullptr, _IOFBF, 1 << 20);
+  fFileName = fileName;
+  fOffset = 0;
+  fWriteError = false;
+  WriteBytes(WaterTankColumnar::kMagic, 8);
+  const std::uint32_t header[2] = {WaterTankColumnar::kVersion, 0};
+  WriteBytes(header, sizeof(header));
+
+  for (auto& table : fTables) {
+    table.nRows = 0;
+    table.fill = 0;
+    table.index.clear();
+    table.buffers[0].firstRow = 0;
+  }
+  fStop = false;
+  fThread = std::thread(&WaterTankColumnarWriter::WriterLoop, this);
+  return true;
+}
+
+void WaterTankColumnarWriter::AddNtupleRow(G4int id)
+{
+  Table& table = fTables[id];
+  if (!fFile || !table.active) return;
+
+  ChunkBuffer& buffer = table.buffers[table.fill];
+  const std::size_t nColumns = table.columns.size();
+  for (std::size_t c = 0; c < nColumns; ++c) {
+    const ColumnSpec& column = table.columns[c];
+    std::vector<char>& data = buffer.data[c];
+    const std::size_t size = WaterTankColumnar::TypeSize(column.type);
+    if (!column.IsVector()) {
+      const std::size_t end = data.size();
+      data.resize(end + size);
+      std::memcpy(data.data() + end, &table.staged[c], size);
+      buffer.bytes += size;
+      continue;
+    }
+    const std::size_t count = column.intVector ? column.intVector->size() : column.floatVector->size();
+    const void* values = column.intVector ? static_cast<const void*>(column.intVector->data())
+                                          : static_cast<const void*>(column.floatVector->data());
+    const std::size_t bytes = count * size;
+    const std::size_t end = data.size();
+    data.resize(end + bytes);
+    if (bytes > 0) std::memcpy(data.data() + end, values, bytes);
+    buffer.lengths[c].push_back(std::uint32_t(count));
+    buffer.bytes += bytes + sizeof(std::uint32_t);
+  }
+  ++buffer.nRows;
+  ++table.nRows;
+  if (buffer.nRows >= kChunkRows || buffer.bytes >= kChunkBytes) SubmitChunk(id);
+}
+
+void WaterTankColumnarWriter::SubmitChunk(G4int id)
+{
+  Table& table = fTables[id];
+  const G4int next = 1 - table.fill;
+  std::unique_lock<std::mutex> lock(fMutex);
+  if (table.buffers[next].inFlight) {
+    const auto start = std::chrono::steady_clock::now();
+    fCondition.wait(lock, [&table, next] { return !table.buffers[next].inFlight; });
+    fStallSeconds += std::chrono::duration<G4double>(std::chrono::steady_clock::now() - start).count();
+  }
+  table.buffers[table.fill].inFlight = true;
+  fQueue.emplace_back(id, table.fill);
+  table.fill = next;
+  table.buffers[next].firstRow = table.nRows;
+  lock.unlock();
+  fCondition.notify_all();
+}
+
+void WaterTankColumnarWriter::WriterLoop()
+{
+  std::unique_lock<std::mutex> lock(fMutex);
+  while (true) {
+    fCondition.wait(lock, [this] { return fStop || !fQueue.empty(); });
+    if (fQueue.empty()) break;
+    const auto job = fQueue.front();
+    fQueue.pop_front();
+    lock.unlock();
+
+    Table& table = fTables[job.first];
+    ChunkBuffer& buffer = table.buffers[job.second];
+    WriteChunk(table, buffer);
+
+    lock.lock();
+    buffer.inFlight = false;
+    fCondition.notify_all();
+  }
+}
+
+void WaterTankColumnarWriter::WriteChunk(Table& table, ChunkBuffer& buffer)
+{
+  ChunkIndex entry;
+  entry.firstRow = buffer.firstRow;
+  entry.nRows = buffer.nRows;
+  for (std::size_t c = 0; c < table.columns.size(); ++c) {
+    const std::uint64_t offset = fOffset;
+    std::uint64_t nValues = buffer.nRows;
+    if (table.columns[c].IsVector()) {
+      const auto& lengths = buffer.lengths[c];
+      WriteBytes(lengths.data(), lengths.size() * sizeof(std::uint32_t));
+      Pad();
+      nValues = buffer.data[c].size() / WaterTankColumnar::TypeSize(table.columns[c].type);
+    }
+    WriteBytes(buffer.data[c].data(), buffer.data[c].size());
+    entry.blocks.push_back(offset);
+    entry.blocks.push_back(fOffset - offset);
+    entry.blocks.push_back(nValues);
+    Pad();
+    buffer.data[c].clear();
+    buffer.lengths[c].clear();
+  }
+  table.index.push_back(std::move(entry));
+  buffer.nRows = 0;
+  buffer.bytes = 0;
+}
+
+void WaterTankColumnarWriter::CloseFile()
+{
+  if (!fFile) return;
+  for (std::size_t id = 0; id < fTables.size(); ++id) {
+    if (fTables[id].buffers[fTables[id].fill].nRows > 0) SubmitChunk(G4int(id));
+  }
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fStop = true;
+  }
+  fCondition.notify_all();
+  fThread.join();
+
+  WriteFooter();
+  if (std::fclose(fFile) != 0) fWriteError = true;
+  fFile = nullptr;
+  if (fWriteError) {
+    G4ExceptionDescription msg;
+    msg << "Writing " << fFileName << " failed; the file is incomplete.";
+    G4Exception("WaterTankColumnarWriter::CloseFile()", "ColumnarOutput002", JustWarning, msg);
+  }
+}
+
+void WaterTankColumnarWriter::WriteFooter()
+{
+  const std::uint64_t footerOffset = fOffset;
+  const auto writeU32 = [this](std::uint32_t value) { WriteBytes(&value, sizeof(value)); };
+  const auto writeU64 = [this](std::uint64_t value) { WriteBytes(&value, sizeof(value)); };
+  const auto writeString = [&](const G4String& value) {
+    writeU32(std::uint32_t(value.size()));
+    WriteBytes(value.data(), value.size());
+  };
+
+  writeU32(std::uint32_t(fTables.size()));
+  for (const auto& table : fTables) {
+    writeString(table.name);
+    writeString(table.title);
+    writeU32(std::uint32_t(table.columns.size()));
+    for (const auto& column : table.columns) {
+      writeString(column.name);
+      const std::uint8_t flags[4] = {column.type, std::uint8_t(column.IsVector() ? 1 : 0), 0, 0};
+      WriteBytes(flags, sizeof(flags));
+    }
+    writeU64(table.nRows);
+    writeU64(table.index.size());
+    for (const auto& entry : table.index) {
+      writeU64(entry.firstRow);
+      writeU32(entry.nRows);
+      writeU32(0);
+      WriteBytes(entry.blocks.data(), entry.blocks.size() * sizeof(std::uint64_t));
+    }
+  }
+  writeU64(footerOffset);
+  WriteBytes(WaterTankColumnar::kEndMagic, 8);
+}
+
+void WaterTankColumnarWriter::WriteBytes(const void* data, std::size_t size)
+{
+  if (size == 0) return;
+  if (std::fwrite(data, 1, size, fFile) != size) fWriteError = true;
+  fOffset += size;
+}
+
+void WaterTankColumnarWriter::Pad()
+{
+  static const char zeros[8] = {};
+  WriteBytes(zeros, (8 - fOffset % 8) % 8);
+}
@@ -0,0 +1,190 @@
+/// \file WaterTankDOMDigitizer.cc
+/// \brief Implementation of the WaterTankDOMDigitizer class
+
+#include "WaterTankDOMDigitizer.hh"
+#include "WaterTankDOMDigitizerMessenger.hh"
+#include "WaterTankDOMSD.hh"
+
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+  // Points per sampling period in the tabulated pulse.
+  const G4int kTemplateOversampling = 16;
+}
+
+WaterTankDOMDigitizer::WaterTankDOMDigitizer(const G4String& name)
+: G4VDigitizerModule(name),
+  fMessenger(nullptr),
+  fDOMSD(nullptr),
+  fPulseShape(kExpGaussPulse),
+  fPulseWidth(2.*ns),
+  fPulseDecay(5.*ns),
+  fSamplingPeriod(3.3*ns),
+  fNumberOfSamples(128),
+  fPretrigger(20.*ns),
+  fThreshold(0.25),
+  fSPEResolution(0.3),
+  fStoreWaveform(true),
+  fTemplateValid(false),
+  fTemplateMin(0.),
+  fTemplateMax(0.),
+  fTemplateStep(0.),
+  fSPEPeakSample(0.),
+  fHasReadout(false),
+  fWindowStart(0.),
+  fCharge(0.),
+  fMeanTime(0.)
+{
+  fMessenger = new WaterTankDOMDigitizerMessenger(this);
+}
+
+WaterTankDOMDigitizer::~WaterTankDOMDigitizer()
+{
+  delete fMessenger;
+}
+
+void WaterTankDOMDigitizer::BuildTemplate()
+{
+  // Support of the pulse: +-6 sigma, plus 10 decay times for expgauss.
+  const G4double sigma = std::max(fPulseWidth, 1.e-3*ns);
+  const G4double decay = (fPulseShape == kExpGaussPulse) ? std::max(fPulseDecay, 1.e-3*ns) : 0.;
+  fTemplateMin = -6. * sigma;
+  fTemplateMax = 6. * sigma + 10. * decay;
+  fTemplateStep = fSamplingPeriod / kTemplateOversampling;
+  const G4int nPoints = G4int(std::ceil((fTemplateMax - fTemplateMin) / fTemplateStep)) + 1;
+  fTemplateMax = fTemplateMin + (nPoints - 1) * fTemplateStep;
+
+  // Cumulative distribution: the Gaussian CDF, or for expgauss the CDF of
+  // the exponentially modified Gaussian,
+  //   Phi(t/s) - exp(-t/tau + s^2/(2 tau^2)) Phi(t/s - s/tau),
+  // evaluated through erfc so that the product stays finite.
+  fTemplate.resize(nPoints);
+  for (G4int i = 0; i < nPoints; ++i) {
+    const G4double t = fTemplateMin + i * fTemplateStep;
+    G4double cdf = 0.5 * std::erfc(-t / (std::sqrt(2.) * sigma));
+    if (decay > 0.) {
+      const G4double shifted = t / sigma - sigma / decay;
+      cdf -= 0.5 * std::exp(-t / decay + 0.5 * sigma * sigma / (decay * decay))
+             * std::erfc(-shifted / std::sqrt(2.));
+    }
+    fTemplate[i] = cdf;
+  }
+  // Normalize the tails away so a whole pulse carries exactly one PE.
+  const G4double low = fTemplate.front();
+  const G4double range = fTemplate.back() - low;
+  for (auto& value : fTemplate) value = (value - low) / range;
+
+  // Largest sample of a single photoelectron over all clock phases.
+  fSPEPeakSample = 0.;
+  for (G4int phase = 0; phase < kTemplateOversampling; ++phase) {
+    for (G4double start = fTemplateMin - phase * fTemplateStep; start < fTemplateMax;
+         start += fSamplingPeriod) {
+      fSPEPeakSample = std::max(fSPEPeakSample,
+                                CumulativeAt(start + fSamplingPeriod) - CumulativeAt(start));
+    }
+  }
+  fTemplateValid = true;
+}
+
+G4double WaterTankDOMDigitizer::CumulativeAt(G4double offset) const
+{
+  if (offset <= fTemplateMin) return 0.;
+  if (offset >= fTemplateMax) return 1.;
+  const G4double position = (offset - fTemplateMin) / fTemplateStep;
+  const std::size_t index = std::size_t(position);
+  const G4double fraction = position - index;
+  return fTemplate[index] + fraction * (fTemplate[index + 1] - fTemplate[index]);
+}
+
+void WaterTankDOMDigitizer::Digitize()
+{
+  fHasReadout = false;
+  fCharge = 0.;
+  fMeanTime = 0.;
+  fWaveform.clear();
+  fPulseTimes.clear();
+  fPulseCharges.clear();
+
+  if (!fDOMSD) {
+    fDOMSD = WaterTankDOMSD::Instance();
+    if (!fDOMSD) return;
+  }
+  const WaterTankDOMHitBuffer& hits = fDOMSD->GetHitBuffer();
+  const std::size_t nHits = hits.Size();
+  if (nHits == 0 || fNumberOfSamples <= 0) return;
+  if (!fTemplateValid) BuildTemplate();
+
+  const G4double* times = hits.GetTime();
+  const float* weights = hits.GetWeight();
+
+  // The window opens on the first hit minus the pretrigger, on a clock tick.
+  G4double firstTime = times[0];
+  for (std::size_t i = 1; i < nHits; ++i) firstTime = std::min(firstTime, times[i]);
+  fWindowStart = std::floor((firstTime - fPretrigger) / fSamplingPeriod) * fSamplingPeriod;
+  fWaveform.assign(fNumberOfSamples, 0.f);
+
+  for (std::size_t i = 0; i < nHits; ++i) {
+    G4double charge = weights[i];
+    if (fSPEResolution > 0.) {
+      charge *= std::max(0., G4RandGauss::shoot(1., fSPEResolution));
+    }
+    // Samples overlapping [hit + fTemplateMin, hit + fTemplateMax].
+    const G4double hitOffset = times[i] - fWindowStart;
+    const G4int first = std::max(0, G4int(std::floor((hitOffset + fTemplateMin) / fSamplingPeriod)));
+    const G4int last = std::min(fNumberOfSamples - 1,
+                                G4int(std::floor((hitOffset + fTemplateMax) / fSamplingPeriod)));
+    G4double previous = CumulativeAt(first * fSamplingPeriod - hitOffset);
+    for (G4int s = first; s <= last; ++s) {
+      const G4double next = CumulativeAt((s + 1) * fSamplingPeriod - hitOffset);
+      fWaveform[s] += float(charge * (next - previous));
+      previous = next;
+    }
+  }
+
+  G4double weightedTime = 0.;
+  for (G4int s = 0; s < fNumberOfSamples; ++s) {
+    fCharge += fWaveform[s];
+    weightedTime += fWaveform[s] * (s + 0.5);
+  }
+  fMeanTime = fCharge > 0. ? fWindowStart + fSamplingPeriod * weightedTime / fCharge : fWindowStart;
+  fHasReadout = true;
+
+  ExtractPulses();
+}
+
+void WaterTankDOMDigitizer::ExtractPulses()
+{
+  // A pulse starts where the waveform crosses the threshold; its time is the
+  // crossing, interpolated between sample centers. Its charge sums the run
+  // of samples above threshold, the sample before the crossing and the
+  // falling tail below threshold, so the whole SPE charge is collected.
+  const G4double threshold = fThreshold * fSPEPeakSample;
+  G4int s = 0;
+  G4int end = 0;
+  while (s < fNumberOfSamples) {
+    if (fWaveform[s] < threshold) { ++s; continue; }
+    G4double crossing = s + 0.5;
+    G4double charge = 0.;
+    if (s > 0) {
+      const G4double rise = fWaveform[s] - fWaveform[s - 1];
+      crossing = s - 0.5 + (rise > 0. ? (threshold - fWaveform[s - 1]) / rise : 1.);
+      if (s - 1 >= end) charge += fWaveform[s - 1];
+    }
+    while (s < fNumberOfSamples && fWaveform[s] >= threshold) {
+      charge += fWaveform[s];
+      ++s;
+    }
+    while (s < fNumberOfSamples && fWaveform[s] > 0.f && fWaveform[s] <= fWaveform[s - 1]) {
+      charge += fWaveform[s];
+      ++s;
+    }
+    end = s;
+    fPulseTimes.push_back(fWindowStart + crossing * fSamplingPeriod);
+    fPulseCharges.push_back(float(charge));
+  }
+}
@@ -0,0 +1,149 @@
+/// \file WaterTankDOMDigitizerMessenger.cc
+/// \brief Implementation of the WaterTankDOMDigitizerMessenger class
+
+#include "WaterTankDOMDigitizerMessenger.hh"
+#include "WaterTankDOMDigitizer.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+
+WaterTankDOMDigitizerMessenger::WaterTankDOMDigitizerMessenger(WaterTankDOMDigitizer* digitizer)
+: G4UImessenger(),
+  fDigitizer(digitizer)
+{
+  // Create directory for DOM readout commands
+  fDigiDirectory = new G4UIdirectory("/watertank/digi/");
+  fDigiDirectory->SetGuidance("DOM waveform digitizer (domdigi output at level digitized and above)");
+
+  // Command to select the single-photoelectron pulse shape
+  fPulseShapeCmd = new G4UIcmdWithAString("/watertank/digi/pulseShape", this);
+  fPulseShapeCmd->SetGuidance("Single-photoelectron pulse shape");
+  fPulseShapeCmd->SetGuidance("  gaussian: Gaussian of width pulseWidth");
+  fPulseShapeCmd->SetGuidance("  expgauss: Gaussian rise convolved with an exponential pulseDecay (default)");
+  fPulseShapeCmd->SetParameterName("shape", false);
+  fPulseShapeCmd->SetCandidates("gaussian expgauss");
+  fPulseShapeCmd->SetDefaultValue("expgauss");
+  fPulseShapeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to set the pulse width
+  fPulseWidthCmd = new G4UIcmdWithADoubleAndUnit("/watertank/digi/pulseWidth", this);
+  fPulseWidthCmd->SetGuidance("Gaussian width (sigma) of the single-photoelectron pulse");
+  fPulseWidthCmd->SetParameterName("width", false);
+  fPulseWidthCmd->SetRange("width > 0.");
+  fPulseWidthCmd->SetDefaultValue(2.);
+  fPulseWidthCmd->SetDefaultUnit("ns");
+  fPulseWidthCmd->SetUnitCategory("Time");
+  fPulseWidthCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to set the pulse decay time
+  fPulseDecayCmd = new G4UIcmdWithADoubleAndUnit("/watertank/digi/pulseDecay", this);
+  fPulseDecayCmd->SetGuidance("Exponential decay time of the expgauss pulse");
+  fPulseDecayCmd->SetParameterName("decay", false);
+  fPulseDecayCmd->SetRange("decay > 0.");
+  fPulseDecayCmd->SetDefaultValue(5.);
+  fPulseDecayCmd->SetDefaultUnit("ns");
+  fPulseDecayCmd->SetUnitCategory("Time");
+  fPulseDecayCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to set the sampling clock
+  fSamplingPeriodCmd = new G4UIcmdWithADoubleAndUnit("/watertank/digi/samplingPeriod", this);
+  fSamplingPeriodCmd->SetGuidance("Sampling period of the waveform");
+  fSamplingPeriodCmd->SetGuidance("  e.g. 3.3 ns for an ATWD-like (default), 25 ns for an FADC-like readout");
+  fSamplingPeriodCmd->SetParameterName("period", false);
+  fSamplingPeriodCmd->SetRange("period > 0.");
+  fSamplingPeriodCmd->SetDefaultValue(3.3);
+  fSamplingPeriodCmd->SetDefaultUnit("ns");
+  fSamplingPeriodCmd->SetUnitCategory("Time");
+  fSamplingPeriodCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to set the window length
+  fSamplesCmd = new G4UIcmdWithAnInteger("/watertank/digi/samples", this);
+  fSamplesCmd->SetGuidance("Number of samples in the readout window (default 128)");
+  fSamplesCmd->SetParameterName("samples", false);
+  fSamplesCmd->SetRange("samples > 0");
+  fSamplesCmd->SetDefaultValue(128);
+  fSamplesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to set the pretrigger
+  fPretriggerCmd = new G4UIcmdWithADoubleAndUnit("/watertank/digi/pretrigger", this);
+  fPretriggerCmd->SetGuidance("Time recorded before the first hit of the event");
+  fPretriggerCmd->SetParameterName("pretrigger", false);
+  fPretriggerCmd->SetRange("pretrigger >= 0.");
+  fPretriggerCmd->SetDefaultValue(20.);
+  fPretriggerCmd->SetDefaultUnit("ns");
+  fPretriggerCmd->SetUnitCategory("Time");
+  fPretriggerCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to set the pulse extraction threshold
+  fThresholdCmd = new G4UIcmdWithADouble("/watertank/digi/threshold", this);
+  fThresholdCmd->SetGuidance("Pulse threshold as a fraction of the single-photoelectron peak sample");
+  fThresholdCmd->SetParameterName("threshold", false);
+  fThresholdCmd->SetRange("threshold > 0.");
+  fThresholdCmd->SetDefaultValue(0.25);
+  fThresholdCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to set the SPE charge resolution
+  fSPEResolutionCmd = new G4UIcmdWithADouble("/watertank/digi/speResolution", this);
+  fSPEResolutionCmd->SetGuidance("Relative Gaussian spread of the single-photoelectron charge (0 for none)");
+  fSPEResolutionCmd->SetParameterName("resolution", false);
+  fSPEResolutionCmd->SetRange("resolution >= 0.");
+  fSPEResolutionCmd->SetDefaultValue(0.3);
+  fSPEResolutionCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to drop the waveform and keep only the extracted pulses
+  fStoreWaveformCmd = new G4UIcmdWithABool("/watertank/digi/storeWaveform", this);
+  fStoreWaveformCmd->SetGuidance("Store the sampled waveform in domdigi besides the extracted pulses");
+  fStoreWaveformCmd->SetParameterName("store", false);
+  fStoreWaveformCmd->SetDefaultValue(true);
+  fStoreWaveformCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+WaterTankDOMDigitizerMessenger::~WaterTankDOMDigitizerMessenger()
+{
+  delete fPulseShapeCmd;
+  delete fPulseWidthCmd;
+  delete fPulseDecayCmd;
+  delete fSamplingPeriodCmd;
+  delete fSamplesCmd;
+  delete fPretriggerCmd;
+  delete fThresholdCmd;
+  delete fSPEResolutionCmd;
+  delete fStoreWaveformCmd;
+  delete fDigiDirectory;
+}
+
+void WaterTankDOMDigitizerMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if (command == fPulseShapeCmd) {
+    fDigitizer->SetPulseShape(newValue == "gaussian" ? WaterTankDOMDigitizer::kGaussianPulse
+                                                     : WaterTankDOMDigitizer::kExpGaussPulse);
+  }
+  else if (command == fPulseWidthCmd) {
+    fDigitizer->SetPulseWidth(fPulseWidthCmd->GetNewDoubleValue(newValue));
+  }
+  else if (command == fPulseDecayCmd) {
+    fDigitizer->SetPulseDecay(fPulseDecayCmd->GetNewDoubleValue(newValue));
+  }
+  else if (command == fSamplingPeriodCmd) {
+    fDigitizer->SetSamplingPeriod(fSamplingPeriodCmd->GetNewDoubleValue(newValue));
+  }
+  else if (command == fSamplesCmd) {
+    fDigitizer->SetNumberOfSamples(fSamplesCmd->GetNewIntValue(newValue));
+  }
+  else if (command == fPretriggerCmd) {
+    fDigitizer->SetPretrigger(fPretriggerCmd->GetNewDoubleValue(newValue));
+  }
+  else if (command == fThresholdCmd) {
+    fDigitizer->SetThreshold(fThresholdCmd->GetNewDoubleValue(newValue));
+  }
+  else if (command == fSPEResolutionCmd) {
+    fDigitizer->SetSPEResolution(fSPEResolutionCmd->GetNewDoubleValue(newValue));
+  }
+  else if (command == fStoreWaveformCmd) {
+    fDigitizer->SetStoreWaveform(fStoreWaveformCmd->GetNewBoolValue(newValue));
+  }
+}
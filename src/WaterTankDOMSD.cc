@@ -3,8 +3,6 @@
 
 #include "WaterTankDOMSD.hh"
 
-#include "WaterTankDOMHit.hh"
-
 #include "G4HCofThisEvent.hh"
 #include "G4Step.hh"
 #include "G4ThreeVector.hh"
@@ -21,37 +19,72 @@
 #include <Randomize.hh>
 #include <algorithm>
 
-WaterTankDOMSD::WaterTankDOMSD(const G4String& name,
-                               const G4String& hitsCollectionName) 
- : G4VSensitiveDetector(name),
-   fHitsCollection(nullptr),
-   fHitsCollectionID(-1)
-{
-  collectionName.insert(hitsCollectionName);
-}
+WaterTankDOMSD::WaterTankDOMSD(const G4String& name)
+ : G4VSensitiveDetector(name)
+{}
 
 WaterTankDOMSD::~WaterTankDOMSD() 
 {}
 
-void WaterTankDOMSD::Initialize(G4HCofThisEvent* hce)
+void WaterTankDOMSD::BuildEfficiencyTable()
 {
-  // Allocate a fresh hits collection at the beginning of each event. The
-  // sensitive detector base class ensures ownership is transferred to the
-  // event when we add it via AddHitsCollection.
-  fHitsCollection = new WaterTankDOMHitsCollection(SensitiveDetectorName, collectionName[0]);
+  fEfficiencyTable.Clear();
+  if (fDOMOpticalSurfaceName.empty() || !fDOMPhysicalVolume || !fWaterPhysicalVolume) {
+    return;
+  }
+
+  // Look up the logical border surface spanning water -> DOM. The optical
+  // efficiency property captures the DOM quantum efficiency vs. wavelength.
+  const G4LogicalBorderSurface* borderSurface =
+    G4LogicalBorderSurface::GetSurface(fWaterPhysicalVolume, fDOMPhysicalVolume);
+  if (!borderSurface) {
+    borderSurface = G4LogicalBorderSurface::GetSurface(fDOMPhysicalVolume, fWaterPhysicalVolume);
+  }
+  if (!borderSurface || borderSurface->GetName() != fDOMOpticalSurfaceName) {
+    G4ExceptionDescription msg;
+    msg << "Border surface " << fDOMOpticalSurfaceName
+        << " not found between water and DOM; every DOM photon will be accepted.";
+    G4Exception("WaterTankDOMSD::BuildEfficiencyTable()",
+                "DOMSD001", JustWarning, msg);
+    return;
+  }
+
+  auto opticalSurface = dynamic_cast<G4OpticalSurface*>(borderSurface->GetSurfaceProperty());
+  if (!opticalSurface) return;
+  auto surfaceMPT = opticalSurface->GetMaterialPropertiesTable();
+  if (!surfaceMPT) return;
+  auto efficiency = surfaceMPT->GetProperty("EFFICIENCY");
+  if (!efficiency) return;
+
+  fEfficiencyTable.Build(*efficiency);
+}
 
-  if (fHitsCollectionID < 0) {
-    fHitsCollectionID = G4SDManager::GetSDMpointer()->GetCollectionID(collectionName[0]);
-  }
+void WaterTankDOMSD::SetQEFirst(G4bool qeFirst)
+{
+  const G4double maxEfficiency = GetMaxEfficiency();
+  fEfficiencyScale = (qeFirst && maxEfficiency > 0.) ? 1. / maxEfficiency : 1.;
+}
 
-  if (fHitsCollectionID >= 0) {
-    hce->AddHitsCollection(fHitsCollectionID, fHitsCollection);
-  }
+void WaterTankDOMSD::Initialize(G4HCofThisEvent*)
+{
+  // Start the event with an empty hit buffer. The storage of previous events
+  // is kept, so busy events do not reallocate once the buffer has grown.
+  fHitBuffer.Clear();
+  fWaterEntryTime = DBL_MAX;
+  fKilledLatePhotons = 0;
+}
+
+G4bool WaterTankDOMSD::ProcessHits(G4Step*, G4TouchableHistory*)
+{
+  // Geant4 only calls this for steps inside the DOM glass. Optical photons are
+  // stopped at the water side of the dielectric_metal surface and reach us
+  // through ProcessBoundaryHit(); charged particles crossing the glass are not
+  // recorded as DOM hits.
+  return false;
 }
 
-G4bool WaterTankDOMSD::ProcessHits(G4Step* aStep, 
-                                   G4TouchableHistory*)
-{  
+G4bool WaterTankDOMSD::ProcessBoundaryHit(const G4Step* aStep)
+{
   // Only optical photons are relevant for DOM detections; all charged
   // particles are handled elsewhere (e.g., energy deposition in water).
   auto track = aStep->GetTrack();
@@ -95,14 +128,12 @@ G4bool WaterTankDOMSD::ProcessHits(G4Step* aStep,
   // For dielectric_metal, the photon may be absorbed without "entering" DOM
   bool enteringDOM = (postVolume == fDOMPhysicalVolume);
   
-  // Also check if we're at the water-DOM boundary by position
-  // The DOM is a sphere of radius 16.5cm at origin
+  // Also check if we're at the water-DOM boundary by position, using the
+  // DOM radius handed over by the detector construction.
   if (!enteringDOM) {
-    G4ThreeVector pos = postPoint->GetPosition();
-    G4double r = pos.mag();
-    G4double domRadius = 16.5 * cm;  // From detector construction
+    G4double r = (postPoint->GetPosition() - fDOMPhysicalVolume->GetTranslation()).mag();
     // If we're at ~DOM radius and step status is boundary, we're hitting DOM
-    if (std::abs(r - domRadius) < 1.0*mm) {
+    if (std::abs(r - fDOMRadius) < 1.0*mm) {
       enteringDOM = true;
     }
   }
@@ -115,67 +146,27 @@ G4bool WaterTankDOMSD::ProcessHits(G4Step* aStep,
     return false;
   }
 
-  if (!fHitsCollection) {
-    return false;
-  }
-
   G4double photonEnergy = postPoint->GetKineticEnergy();
   if (photonEnergy <= 0.) {
     photonEnergy = track->GetKineticEnergy();
   }
 
-  // Determine detection probability from optical surface, if available
-  G4double detectionProbability = 1.0;
-  if (!fDOMOpticalSurfaceName.empty()) {
-    // Look up the logical border surface spanning water -> DOM. The optical
-    // efficiency property captures the DOM quantum efficiency vs. wavelength.
-    const G4LogicalBorderSurface* borderSurface =
-      G4LogicalBorderSurface::GetSurface(preVolume, postVolume);
-    if (!borderSurface) {
-      borderSurface = G4LogicalBorderSurface::GetSurface(postVolume, preVolume);
-    }
-    if (borderSurface) {
-      auto surfaceProperty = borderSurface->GetSurfaceProperty();
-      auto opticalSurface = dynamic_cast<G4OpticalSurface*>(surfaceProperty);
-      if (opticalSurface) {
-        auto surfaceMPT = opticalSurface->GetMaterialPropertiesTable();
-        if (surfaceMPT) {
-          auto efficiency = surfaceMPT->GetProperty("EFFICIENCY");
-          if (efficiency) {
-            detectionProbability = efficiency->Value(photonEnergy);
-          }
-        }
-      }
-    }
-  }
+  // Determine detection probability from the pre-resolved efficiency curve.
+  // Photons recognized by position alone reached the same DOM surface, so
+  // they are sampled the same way, as in the table, fast-model and analytic
+  // paths. In QE-first mode the scale turns the curve into the relative
+  // efficiency, compensating the thinning applied when they were created.
+  const G4double detectionProbability = GetDetectionProbability(photonEnergy);
 
-  if (detectionProbability <= 0.) {
-    return false;
-  }
-
-  detectionProbability = std::min(1.0, std::max(0.0, detectionProbability));
-  if (detectionProbability < 1.0 && G4UniformRand() > detectionProbability) {
+  if (!SampleDetection(detectionProbability)) {
     return false;
   }
 
-  // At this point the photon is deemed detected. Build a hit object capturing
-  // arrival time, position, direction, and provenance for downstream analysis.
-  auto hit = new WaterTankDOMHit();
-  hit->SetTime(postPoint->GetGlobalTime());
-  hit->SetPosition(postPoint->GetPosition());
-  hit->SetDirection(postPoint->GetMomentumDirection().unit());
-
-  hit->SetPhotonEnergy(photonEnergy);
-
-  G4double wavelength = 0.;
-  if (photonEnergy > 0.) {
-    wavelength = (h_Planck * c_light) / photonEnergy;
-  }
-  hit->SetWavelength(wavelength);
-  hit->SetTrackID(track->GetTrackID());
-  hit->SetParentID(track->GetParentID());
-
-  fHitsCollection->insert(hit);
+  // At this point the photon is deemed detected. Record arrival time,
+  // position, direction, and provenance for downstream analysis.
+  AddHit(postPoint->GetGlobalTime(), postPoint->GetPosition(),
+         postPoint->GetMomentumDirection().unit(), photonEnergy,
+         track->GetTrackID(), track->GetParentID(), track->GetWeight());
 
   // Reduce console spam: per-photon printing was flooding logs during large
   // CRY runs. Keep the hit stored for analysis and avoid printing here.
@@ -185,7 +176,6 @@ G4bool WaterTankDOMSD::ProcessHits(G4Step* aStep,
   //        << " parent=" << track->GetParentID()
   //        << " time=" << postPoint->GetGlobalTime()/ns << " ns"
   //        << " energy=" << photonEnergy/eV << " eV"
-  //        << " wavelength=" << wavelength/nm << " nm"
   //        << G4endl;
 
   // Terminate the optical photon track once it has triggered the DOM to avoid
@@ -195,7 +185,44 @@ G4bool WaterTankDOMSD::ProcessHits(G4Step* aStep,
   return true;
 }
 
+G4double WaterTankDOMSD::GetDetectionProbability(G4double photonEnergy) const
+{
+  if (!fEfficiencyTable.IsValid()) {
+    return 1.0;
+  }
+  return fEfficiencyTable.Value(photonEnergy) * fEfficiencyScale;
+}
+
+G4bool WaterTankDOMSD::SampleDetection(G4double detectionProbability) const
+{
+  if (detectionProbability <= 0.) {
+    return false;
+  }
+
+  detectionProbability = std::min(1.0, std::max(0.0, detectionProbability));
+  if (detectionProbability < 1.0 && G4UniformRand() > detectionProbability) {
+    return false;
+  }
+  return true;
+}
+
+void WaterTankDOMSD::AddHit(G4double time, const G4ThreeVector& position,
+                            const G4ThreeVector& direction, G4double photonEnergy,
+                            G4int trackID, G4int parentID, G4double weight)
+{
+  if (IsAfterWindow(time)) {
+    AddKilledLatePhoton();
+    return;
+  }
+  fHitBuffer.Add(time, position, direction, photonEnergy, trackID, parentID, weight);
+}
+
 void WaterTankDOMSD::EndOfEvent(G4HCofThisEvent*)
 {
-  // Optional: summarize hits at end of event
-}
\ No newline at end of file
+  // Hits were checked against the window as it was when they were added. A
+  // charged particle tracked later may have opened it earlier, so apply the
+  // final window before the event action reads the buffer.
+  if (fTimeWindow > 0. && fWaterEntryTime < DBL_MAX) {
+    fKilledLatePhotons += G4int(fHitBuffer.EraseLaterThan(fWaterEntryTime + fTimeWindow));
+  }
+}
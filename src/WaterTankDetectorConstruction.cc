@@ -20,7 +20,9 @@
 #include "G4LogicalBorderSurface.hh"
 #include "G4PhysicalConstants.hh"
 #include "WaterTankDOMSD.hh"
+#include "WaterTankMuonCherenkovModel.hh"
 #include "G4SDManager.hh"
+#include "G4Region.hh"
 
 WaterTankDetectorConstruction::WaterTankDetectorConstruction()
 : G4VUserDetectorConstruction(),
@@ -28,7 +30,10 @@ WaterTankDetectorConstruction::WaterTankDetectorConstruction()
   fDOMLogicalVolume(nullptr),
   fWaterLogicalVolume(nullptr),
   fWaterPhysicalVolume(nullptr),
-  fDOMPhysicalVolume(nullptr)
+  fDOMPhysicalVolume(nullptr),
+  fDOMRadius(0.),
+  fDOMOpticalSurface(nullptr),
+  fWaterRegion(nullptr)
 { }
 
 WaterTankDetectorConstruction::~WaterTankDetectorConstruction()
@@ -163,6 +168,12 @@ G4VPhysicalVolume* WaterTankDetectorConstruction::Construct()
   );
   fWaterLogicalVolume = logicTankWater;
 
+  // Region hosting the muon Cherenkov fast-simulation model. The DOM is a
+  // daughter of the water and inherits the region; the model itself only acts
+  // on muons in the water.
+  fWaterRegion = new G4Region("WaterRegion");
+  fWaterRegion->AddRootLogicalVolume(logicTankWater);
+
   // Visualization attributes: distinct translucent colors
   auto visShell = new G4VisAttributes(G4Colour(0.95, 0.85, 0.1, 0.3)); // translucent yellow
   visShell->SetForceSolid(true);
@@ -182,7 +193,7 @@ G4VPhysicalVolume* WaterTankDetectorConstruction::Construct()
   // --------------------------------------------------------------
   
   // DOM dimensions (approximate IceCube DOM specs)
-  G4double domRadius = 16.5*cm;  // ~13" diameter glass sphere
+  fDOMRadius = 16.5*cm;  // ~13" diameter glass sphere
   
   // Materials
   G4Material* matGlass = nist->FindOrBuildMaterial("G4_Pyrex_Glass");
@@ -216,7 +227,7 @@ G4VPhysicalVolume* WaterTankDetectorConstruction::Construct()
   G4Sphere* solidDOMSphere = new G4Sphere(
     "DOMSphere",
     0.,                 // inner radius
-    domRadius,          // outer radius  
+    fDOMRadius,         // outer radius  
     0.*deg, 360.*deg,   // phi range
     0.*deg, 180.*deg    // theta range (full sphere)
   );
@@ -265,6 +276,7 @@ G4VPhysicalVolume* WaterTankDetectorConstruction::Construct()
   domSurfaceMPT->AddProperty("EFFICIENCY", photonEnergy, domEfficiency, nOptPhotons);
   domSurfaceMPT->AddProperty("REFLECTIVITY", photonEnergy, domReflectivity, nOptPhotons);
   domOpticalSurface->SetMaterialPropertiesTable(domSurfaceMPT);
+  fDOMOpticalSurface = domOpticalSurface;
 
   // Bind the optical surface to the physical interface bordering water and the
   // DOM. The sensitive detector will later query this same surface to decide
@@ -288,22 +300,30 @@ G4VPhysicalVolume* WaterTankDetectorConstruction::Construct()
 void WaterTankDetectorConstruction::ConstructSDandField()
 {
   // Create sensitive detector for DOM. This converts optical photons that
-  // enter the DOM into hits and records their kinematics.
-  G4String DOMSDname = "WaterTank/DOMSD";
-  WaterTankDOMSD* domSD = new WaterTankDOMSD(DOMSDname, "DOMHitsCollection");
+  // reach the DOM into hits and records their kinematics.
+  G4String DOMSDname = WaterTankDOMSD::kName;
+  WaterTankDOMSD* domSD = new WaterTankDOMSD(DOMSDname);
   domSD->SetDOMPhysicalVolume(fDOMPhysicalVolume);
   domSD->SetWaterPhysicalVolume(fWaterPhysicalVolume);
   domSD->SetDOMOpticalSurfaceName("DOMOpticalSurfaceBorder");
+  domSD->SetDOMRadius(fDOMRadius);
+  // Resolve the efficiency curve now so each thread's SD holds its own flat
+  // lookup table instead of searching the border surfaces per photon.
+  domSD->BuildEfficiencyTable();
   G4SDManager::GetSDMpointer()->AddNewDetector(domSD);
-  
-  // Attach sensitive detector to both DOM and water logical volumes.
-  // The SD needs to be on the water volume to catch optical photons as they
-  // cross from water into the DOM boundary. The SD logic filters for only
-  // boundary-crossing optical photons from water→DOM.
+
+  // Attach the sensitive detector to the DOM glass only. The dielectric_metal
+  // surface stops photons at the water side of the boundary, so detections are
+  // fed in by the stepping action for boundary steps ending on the DOM rather
+  // than by binding the SD to the water, which made Geant4 call ProcessHits for
+  // every optical photon step in the tank.
   if (fDOMLogicalVolume) {
     SetSensitiveDetector(fDOMLogicalVolume, domSD);
   }
-  if (fWaterLogicalVolume) {
-    SetSensitiveDetector(fWaterLogicalVolume, domSD);
+
+  // Fast-simulation models are thread-local like the SD they write into. The
+  // model stays dormant until /watertank/optics/mode fast is selected.
+  if (fWaterRegion) {
+    new WaterTankMuonCherenkovModel("WaterTankMuonCherenkovModel", fWaterRegion, this, domSD);
   }
 }
@@ -4,15 +4,18 @@
 #include "WaterTankEventAction.hh"
 #include "WaterTankRunAction.hh"
 #include "WaterTankAnalysis.hh"
-#include "WaterTankDOMHit.hh"
+#include "WaterTankDOMSD.hh"
+#include "WaterTankDOMDigitizer.hh"
+#include "WaterTankOutputEncoding.hh"
 
 #include "G4Event.hh"
 #include "G4RunManager.hh"
 #include "G4ParticleGun.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
 #include "G4AnalysisManager.hh"
 #include "G4SDManager.hh"
-#include "G4HCofThisEvent.hh"
+#include "G4DigiManager.hh"
 #include "G4PrimaryVertex.hh"
 #include "G4PrimaryParticle.hh"
 #include "G4ThreeVector.hh"
@@ -24,9 +27,13 @@ WaterTankEventAction::WaterTankEventAction(WaterTankRunAction* runAction)
 : G4UserEventAction(),
   fRunAction(runAction),
   fEdep(0.),
-  fDetectionCount(0),
-  fDOMHCID(-1)
+  fDetectionCount(0.),
+  fDOMSD(nullptr),
+  fDigitizer(nullptr)
 {
+  // The digi manager is thread-local and takes ownership of the module.
+  fDigitizer = new WaterTankDOMDigitizer("WaterTankDOMDigitizer");
+  G4DigiManager::GetDMpointer()->AddNewModule(fDigitizer);
 }
 
 WaterTankEventAction::~WaterTankEventAction()
@@ -34,18 +41,22 @@ WaterTankEventAction::~WaterTankEventAction()
 
 void WaterTankEventAction::BeginOfEventAction(const G4Event*)
 {    
+  // Continue in a new output file if the last event completed a chunk.
+  fRunAction->BeginEventOutput();
+
   // Reset per-event accumulators. The stepping action will add deposited
   // energy, while the sensitive detector will populate hits which we count at
   // the end of the event.
   fEdep = 0.;
-  fDetectionCount = 0;
+  fDetectionCount = 0.;
 }
 
 void WaterTankEventAction::EndOfEventAction(const G4Event* event)
 {   
   // accumulate statistics in run action
   fRunAction->AddEdep(fEdep);
-  auto analysisManager = G4AnalysisManager::Instance();
+  // Rows go to the ROOT and/or columnar ntuples, depending on the output format.
+  WaterTankNtupleOutput& output = fRunAction->GetNtupleOutput();
   const G4int eventId = event->GetEventID();
 
   // Get primary particle information
@@ -64,110 +75,240 @@ void WaterTankEventAction::EndOfEventAction(const G4Event* event)
     primaryDir = primaryParticle->GetMomentumDirection();
   }
 
-  // Retrieve DOM hits collection and count detections. We cache the collection
-  // ID after the first lookup to avoid repeated string-based searches.
-  auto hce = event->GetHCofThisEvent();
-  WaterTankDOMHitsCollection* domHits = nullptr;
-  if (hce) {
-    if (fDOMHCID < 0) {
-      fDOMHCID = G4SDManager::GetSDMpointer()->GetCollectionID("DOMHitsCollection");
-    }
-    if (fDOMHCID >= 0 && fDOMHCID < hce->GetNumberOfCollections()) {
-      domHits = static_cast<WaterTankDOMHitsCollection*>(hce->GetHC(fDOMHCID));
-    }
-  }
+  // The DOM hits live in the thread's SD; look it up once.
+  if (!fDOMSD) fDOMSD = WaterTankDOMSD::Instance();
+  const WaterTankDOMHitBuffer* domHits = fDOMSD ? &fDOMSD->GetHitBuffer() : nullptr;
+  const std::size_t nHits = domHits ? domHits->Size() : 0;
 
-  fDetectionCount = (domHits) ? static_cast<G4int>(domHits->entries()) : 0;
+  // Each hit counts with its weight, so with photon bundles the detection
+  // count is the weighted sum and its variance the sum of squared weights.
+  // Without bundling all weights are one and these reduce to plain counts.
+  // Timing statistics (weighted min/max/mean/RMS, median and the configured
+  // quantiles) come from one selection-based pass over the hit buffer.
+  const std::vector<G4double>& timeQuantiles = fRunAction->GetTimeQuantiles();
+  fTimeStatistics.Compute(nHits > 0 ? domHits->GetTime() : nullptr,
+                          nHits > 0 ? domHits->GetWeight() : nullptr, nHits, timeQuantiles);
+  fDetectionCount = fTimeStatistics.GetSumWeight();
+  const G4double detectionVariance = fTimeStatistics.GetSumWeight2();
 
-  // Calculate physics analysis variables
-  G4double photonYield = (primaryEnergy > 0) ? fDetectionCount / (primaryEnergy/GeV) : 0.0;
-  G4double firstPhotonTime = 1e9;  // Initialize to large value
-  G4double lastPhotonTime = -1e9;  // Initialize to small value
+  G4double firstPhotonTime = -1.0;  // -1 flags events without photons
+  G4double lastPhotonTime = -1.0;
   G4double avgWavelength = 0.0;
-  G4double timeRMS = 0.0;
-  G4double timeMedian = 0.0;
+  const G4double timeRMS = fTimeStatistics.GetRMS();
+  const G4double timeMedian = fTimeStatistics.GetMedian();
   
-  if (domHits && fDetectionCount > 0) {
+  if (nHits > 0) {
+    firstPhotonTime = fTimeStatistics.GetMin();
+    lastPhotonTime = fTimeStatistics.GetMax();
+
     G4double sumWavelength = 0.0;
-    G4double sumTime = 0.0;
-    G4double sumTime2 = 0.0;
-    std::vector<G4double> hitTimes;
-    hitTimes.reserve(fDetectionCount);
-    
-    for (G4int ihit = 0; ihit < domHits->entries(); ++ihit) {
-      auto hit = (*domHits)[ihit];
-      if (!hit) continue;
-      G4double hitTime = hit->GetTime();
-      hitTimes.push_back(hitTime);
-      sumTime += hitTime;
-      sumTime2 += hitTime * hitTime;
-      if (hitTime < firstPhotonTime) firstPhotonTime = hitTime;
-      if (hitTime > lastPhotonTime) lastPhotonTime = hitTime;
-      sumWavelength += hit->GetWavelength();
+    const float* energies = domHits->GetEnergy();
+    const float* weights = domHits->GetWeight();
+    for (std::size_t ihit = 0; ihit < nHits; ++ihit) {
+      if (energies[ihit] > 0.f) {
+        sumWavelength += weights[ihit] * (h_Planck * c_light) / energies[ihit];
+      }
     }
     avgWavelength = sumWavelength / fDetectionCount;
-    
-    // Compute time statistics
-    G4double meanTime = sumTime / fDetectionCount;
-    G4double variance = (sumTime2 / fDetectionCount) - (meanTime * meanTime);
-    timeRMS = (variance > 0) ? std::sqrt(variance) : 0.0;
-    
-    // Compute median time
-    if (!hitTimes.empty()) {
-      std::sort(hitTimes.begin(), hitTimes.end());
-      size_t n = hitTimes.size();
-      if (n % 2 == 0) {
-        timeMedian = (hitTimes[n/2 - 1] + hitTimes[n/2]) / 2.0;
-      } else {
-        timeMedian = hitTimes[n/2];
+  }
+
+  // Calculate physics analysis variables
+  G4double photonYield = (primaryEnergy > 0) ? fDetectionCount / (primaryEnergy/GeV) : 0.0;
+
+  // Fill event ntuple with enhanced data
+  output.FillNtupleIColumn(0, 0, eventId);
+  output.FillNtupleDColumn(0, 1, fEdep/GeV);
+  output.FillNtupleDColumn(0, 2, fDetectionCount);
+  output.FillNtupleIColumn(0, 3, primaryPDG);
+  output.FillNtupleDColumn(0, 4, primaryEnergy/GeV);
+  output.FillNtupleDColumn(0, 5, primaryPos.x()/cm);
+  output.FillNtupleDColumn(0, 6, primaryPos.y()/cm);
+  output.FillNtupleDColumn(0, 7, primaryPos.z()/cm);
+  output.FillNtupleDColumn(0, 8, primaryDir.x());
+  output.FillNtupleDColumn(0, 9, primaryDir.y());
+  output.FillNtupleDColumn(0, 10, primaryDir.z());
+  output.FillNtupleDColumn(0, 11, photonYield);
+  output.FillNtupleDColumn(0, 12, firstPhotonTime/ns);
+  output.FillNtupleDColumn(0, 13, lastPhotonTime/ns);
+  output.FillNtupleDColumn(0, 14, avgWavelength/nm);
+  output.FillNtupleDColumn(0, 15, timeRMS/ns);
+  output.FillNtupleDColumn(0, 16, timeMedian/ns);
+  output.FillNtupleDColumn(0, 17, detectionVariance);
+  output.FillNtupleIColumn(0, 18, fDOMSD ? fDOMSD->GetKilledLatePhotons() : 0);
+  const std::vector<G4double>& quantileTimes = fTimeStatistics.GetQuantiles();
+  for (std::size_t i = 0; i < quantileTimes.size(); ++i) {
+    output.FillNtupleDColumn(0, WaterTankRunAction::kFirstQuantileColumn + G4int(i),
+                             nHits > 0 ? quantileTimes[i]/ns : -1.0);
+  }
+  output.AddNtupleRow(0);
+
+  const WaterTankRunAction::OutputLevel outputLevel = fRunAction->GetOutputLevel();
+
+  // Digitized readout of the (single) DOM when it saw light: the waveform
+  // and its pulses, with the integrated charge, the first pulse time and the
+  // charge-weighted time.
+  if (outputLevel >= WaterTankRunAction::kDigitizedOutput && nHits > 0) {
+    G4DigiManager::GetDMpointer()->Digitize("WaterTankDOMDigitizer");
+    if (fDigitizer->HasReadout()) {
+      const auto& pulseTimes = fDigitizer->GetPulseTimes();
+      auto& digi = fRunAction->GetDigiColumns();
+      if (fDigitizer->GetStoreWaveform()) digi.waveform = fDigitizer->GetWaveform();
+      else digi.waveform.clear();
+      // Pulse times are stored as float offsets from the window start.
+      const G4double windowStart = fDigitizer->GetWindowStart();
+      digi.pulseTime.resize(pulseTimes.size());
+      for (std::size_t i = 0; i < pulseTimes.size(); ++i) {
+        digi.pulseTime[i] = (pulseTimes[i] - windowStart) / ns;
       }
+      digi.pulseCharge = fDigitizer->GetPulseCharges();
+
+      output.FillNtupleIColumn(2, 0, eventId);
+      output.FillNtupleIColumn(2, 1, 0);
+      output.FillNtupleDColumn(2, 2, fDigitizer->GetCharge());
+      output.FillNtupleDColumn(2, 3, pulseTimes.empty() ? -1. : pulseTimes.front()/ns);
+      output.FillNtupleDColumn(2, 4, fDigitizer->GetMeanTime()/ns);
+      output.FillNtupleIColumn(2, 5, G4int(pulseTimes.size()));
+      output.FillNtupleDColumn(2, 6, windowStart/ns);
+      output.FillNtupleDColumn(2, 7, fDigitizer->GetSamplingPeriod()/ns);
+      output.AddNtupleRow(2);
     }
-  } else {
-    firstPhotonTime = -1.0;  // No photons detected
-    lastPhotonTime = -1.0;
   }
 
-  // Fill event ntuple with enhanced data
-  analysisManager->FillNtupleIColumn(0, 0, eventId);
-  analysisManager->FillNtupleDColumn(0, 1, fEdep/GeV);
-  analysisManager->FillNtupleIColumn(0, 2, fDetectionCount);
-  analysisManager->FillNtupleIColumn(0, 3, primaryPDG);
-  analysisManager->FillNtupleDColumn(0, 4, primaryEnergy/GeV);
-  analysisManager->FillNtupleDColumn(0, 5, primaryPos.x()/cm);
-  analysisManager->FillNtupleDColumn(0, 6, primaryPos.y()/cm);
-  analysisManager->FillNtupleDColumn(0, 7, primaryPos.z()/cm);
-  analysisManager->FillNtupleDColumn(0, 8, primaryDir.x());
-  analysisManager->FillNtupleDColumn(0, 9, primaryDir.y());
-  analysisManager->FillNtupleDColumn(0, 10, primaryDir.z());
-  analysisManager->FillNtupleDColumn(0, 11, photonYield);
-  analysisManager->FillNtupleDColumn(0, 12, firstPhotonTime/ns);
-  analysisManager->FillNtupleDColumn(0, 13, lastPhotonTime/ns);
-  analysisManager->FillNtupleDColumn(0, 14, avgWavelength/nm);
-  analysisManager->FillNtupleDColumn(0, 15, timeRMS/ns);
-  analysisManager->FillNtupleDColumn(0, 16, timeMedian/ns);
-  analysisManager->AddNtupleRow(0);
-
-  // Populate the hits ntuple with one row per DOM detection. Units are chosen
-  // to be human-friendly (ns, eV, nm, cm) for downstream analysis in ROOT.
-  if (domHits) {
-    for (G4int ihit = 0; ihit < domHits->entries(); ++ihit) {
-      auto hit = (*domHits)[ihit];
-      if (!hit) continue;
-      analysisManager->FillNtupleIColumn(1, 0, eventId);
-      analysisManager->FillNtupleIColumn(1, 1, hit->GetTrackID());
-      analysisManager->FillNtupleIColumn(1, 2, hit->GetParentID());
-      analysisManager->FillNtupleDColumn(1, 3, hit->GetTime()/ns);
-      analysisManager->FillNtupleDColumn(1, 4, hit->GetPhotonEnergy()/eV);
-      analysisManager->FillNtupleDColumn(1, 5, hit->GetWavelength()/nm);
-      const auto& pos = hit->GetPosition();
-      analysisManager->FillNtupleDColumn(1, 6, pos.x()/cm);
-      analysisManager->FillNtupleDColumn(1, 7, pos.y()/cm);
-      analysisManager->FillNtupleDColumn(1, 8, pos.z()/cm);
-      const auto& dir = hit->GetDirection();
-      analysisManager->FillNtupleDColumn(1, 9, dir.x());
-      analysisManager->FillNtupleDColumn(1, 10, dir.y());
-      analysisManager->FillNtupleDColumn(1, 11, dir.z());
-      analysisManager->AddNtupleRow(1);
+  // Populate the hits ntuple with every DOM detection. Units are chosen to be
+  // human-friendly (ns, eV, nm, cm) for downstream analysis in ROOT. This is
+  // by far the largest output, so it is skipped below full level.
+  if (outputLevel >= WaterTankRunAction::kFullOutput && nHits > 0
+      && fRunAction->IsVectorHitLayout()) {
+    // Vector layout: refill the vectors bound to the columns, one row per
+    // event. Each column group is written either as floats or, when its
+    // precision was reduced, as fixed-point integers. Hit times are offsets
+    // from the first hit, stored in double precision once per event, so that
+    // they keep their precision whatever the global time of the event.
+    WaterTankRunAction::HitColumns& columns = fRunAction->GetHitColumns();
+    const WaterTankRunAction::HitPrecision& precision = fRunAction->GetHitPrecision();
+    const G4double timeReference = firstPhotonTime;
+    long nClamped = 0;
+    const G4double* times = domHits->GetTime();
+    const float* energies = domHits->GetEnergy();
+    const float* posX = domHits->GetPositionX();
+    const float* posY = domHits->GetPositionY();
+    const float* posZ = domHits->GetPositionZ();
+    const float* dirX = domHits->GetDirectionX();
+    const float* dirY = domHits->GetDirectionY();
+    const float* dirZ = domHits->GetDirectionZ();
+    columns.trackID.assign(domHits->GetTrackID(), domHits->GetTrackID() + nHits);
+    columns.parentID.assign(domHits->GetParentID(), domHits->GetParentID() + nHits);
+    columns.weight.assign(domHits->GetWeight(), domHits->GetWeight() + nHits);
+
+    if (precision.timeStep > 0.) {
+      columns.timeTicks.resize(nHits);
+      for (std::size_t ihit = 0; ihit < nHits; ++ihit) {
+        columns.timeTicks[ihit] = WaterTankOutputEncoding::Quantize((times[ihit] - timeReference)/ns,
+                                                                    precision.timeStep, nClamped);
+      }
+    } else {
+      columns.time.resize(nHits);
+      for (std::size_t ihit = 0; ihit < nHits; ++ihit) {
+        columns.time[ihit] = (times[ihit] - timeReference)/ns;
+      }
+    }
+
+    if (precision.energyStep > 0.) {
+      columns.energyTicks.resize(nHits);
+      for (std::size_t ihit = 0; ihit < nHits; ++ihit) {
+        columns.energyTicks[ihit] = WaterTankOutputEncoding::Quantize(energies[ihit]/eV, precision.energyStep,
+                                                                      nClamped);
+      }
+    } else {
+      columns.energy.resize(nHits);
+      columns.wavelength.resize(nHits);
+      for (std::size_t ihit = 0; ihit < nHits; ++ihit) {
+        const G4double energy = energies[ihit];
+        columns.energy[ihit] = energy/eV;
+        columns.wavelength[ihit] = energy > 0. ? (h_Planck * c_light) / energy / nm : 0.;
+      }
+    }
+
+    if (precision.positionStep > 0.) {
+      columns.posXTicks.resize(nHits);
+      columns.posYTicks.resize(nHits);
+      columns.posZTicks.resize(nHits);
+      for (std::size_t ihit = 0; ihit < nHits; ++ihit) {
+        columns.posXTicks[ihit] = WaterTankOutputEncoding::Quantize(posX[ihit]/cm, precision.positionStep, nClamped);
+        columns.posYTicks[ihit] = WaterTankOutputEncoding::Quantize(posY[ihit]/cm, precision.positionStep, nClamped);
+        columns.posZTicks[ihit] = WaterTankOutputEncoding::Quantize(posZ[ihit]/cm, precision.positionStep, nClamped);
+      }
+    } else {
+      columns.posX.resize(nHits);
+      columns.posY.resize(nHits);
+      columns.posZ.resize(nHits);
+      for (std::size_t ihit = 0; ihit < nHits; ++ihit) {
+        columns.posX[ihit] = posX[ihit]/cm;
+        columns.posY[ihit] = posY[ihit]/cm;
+        columns.posZ[ihit] = posZ[ihit]/cm;
+      }
+    }
+
+    if (precision.octahedralDirections) {
+      columns.dirOctahedral.resize(nHits);
+      for (std::size_t ihit = 0; ihit < nHits; ++ihit) {
+        columns.dirOctahedral[ihit] = WaterTankOutputEncoding::EncodeOctahedral(dirX[ihit], dirY[ihit], dirZ[ihit]);
+      }
+    } else {
+      columns.dirX.assign(dirX, dirX + nHits);
+      columns.dirY.assign(dirY, dirY + nHits);
+      columns.dirZ.assign(dirZ, dirZ + nHits);
+    }
+    if (nClamped > 0) {
+      G4ExceptionDescription msg;
+      msg << "Event " << eventId << ": " << nClamped << " quantized hit values exceed the int"
+          << " range and were clamped; use a coarser /watertank/output/precision step.";
+      G4Exception("WaterTankEventAction::EndOfEventAction()", "RunOutput006", JustWarning, msg);
+    }
+    output.FillNtupleIColumn(1, 0, eventId);
+    output.FillNtupleIColumn(1, 1, G4int(nHits));
+    output.FillNtupleDColumn(1, 2, timeReference/ns);
+    G4int stepColumn = 3;
+    if (precision.timeStep > 0.) output.FillNtupleDColumn(1, stepColumn++, precision.timeStep);
+    if (precision.energyStep > 0.) output.FillNtupleDColumn(1, stepColumn++, precision.energyStep);
+    if (precision.positionStep > 0.) output.FillNtupleDColumn(1, stepColumn++, precision.positionStep);
+    output.AddNtupleRow(1);
+  }
+  else if (outputLevel >= WaterTankRunAction::kFullOutput && nHits > 0) {
+    // Row layout: one row per detected photon.
+    const G4double* times = domHits->GetTime();
+    const float* energies = domHits->GetEnergy();
+    const float* posX = domHits->GetPositionX();
+    const float* posY = domHits->GetPositionY();
+    const float* posZ = domHits->GetPositionZ();
+    const float* dirX = domHits->GetDirectionX();
+    const float* dirY = domHits->GetDirectionY();
+    const float* dirZ = domHits->GetDirectionZ();
+    const float* weights = domHits->GetWeight();
+    const G4int* trackIDs = domHits->GetTrackID();
+    const G4int* parentIDs = domHits->GetParentID();
+    for (std::size_t ihit = 0; ihit < nHits; ++ihit) {
+      const G4double energy = energies[ihit];
+      const G4double wavelength = energy > 0. ? (h_Planck * c_light) / energy : 0.;
+      output.FillNtupleIColumn(1, 0, eventId);
+      output.FillNtupleIColumn(1, 1, trackIDs[ihit]);
+      output.FillNtupleIColumn(1, 2, parentIDs[ihit]);
+      output.FillNtupleDColumn(1, 3, times[ihit]/ns);
+      output.FillNtupleDColumn(1, 4, energy/eV);
+      output.FillNtupleDColumn(1, 5, wavelength/nm);
+      output.FillNtupleDColumn(1, 6, posX[ihit]/cm);
+      output.FillNtupleDColumn(1, 7, posY[ihit]/cm);
+      output.FillNtupleDColumn(1, 8, posZ[ihit]/cm);
+      output.FillNtupleDColumn(1, 9, dirX[ihit]);
+      output.FillNtupleDColumn(1, 10, dirY[ihit]);
+      output.FillNtupleDColumn(1, 11, dirZ[ihit]);
+      output.FillNtupleDColumn(1, 12, weights[ihit]);
+      output.AddNtupleRow(1);
     }
   }
+
+  // With asynchronous output the rows above were only recorded; this hands
+  // them to the writer thread.
+  output.SubmitEvent();
+  fRunAction->EndEventOutput(eventId);
 }
@@ -0,0 +1,52 @@
+/// \file WaterTankMuonCherenkovMessenger.cc
+/// \brief Implementation of the WaterTankMuonCherenkovMessenger class
+
+#include "WaterTankMuonCherenkovMessenger.hh"
+#include "WaterTankMuonCherenkovModel.hh"
+
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+
+WaterTankMuonCherenkovMessenger::WaterTankMuonCherenkovMessenger(WaterTankMuonCherenkovModel* model)
+: G4UImessenger(),
+  fModel(model)
+{
+  // The /watertank/optics/ directory is owned by the stacking messenger.
+
+  // Command to switch between full and fast muon light
+  fModeCmd = new G4UIcmdWithAString("/watertank/optics/mode", this);
+  fModeCmd->SetGuidance("Select how Cherenkov light from muons in the water is simulated");
+  fModeCmd->SetGuidance("  full: Geant4 tracks the muon and every Cherenkov photon (default)");
+  fModeCmd->SetGuidance("  fast: muons are moved by the fast-simulation model, which samples");
+  fModeCmd->SetGuidance("        DOM hits from the Frank-Tamm yield without creating photons");
+  fModeCmd->SetParameterName("mode", false);
+  fModeCmd->SetCandidates("full fast");
+  fModeCmd->SetDefaultValue("full");
+  fModeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to set the fast model segment length
+  fSegmentLengthCmd = new G4UIcmdWithADoubleAndUnit("/watertank/optics/fastSegmentLength", this);
+  fSegmentLengthCmd->SetGuidance("Length of the muon segments on which the fast model samples light");
+  fSegmentLengthCmd->SetParameterName("length", false);
+  fSegmentLengthCmd->SetRange("length > 0.");
+  fSegmentLengthCmd->SetDefaultValue(1.);
+  fSegmentLengthCmd->SetDefaultUnit("cm");
+  fSegmentLengthCmd->SetUnitCategory("Length");
+  fSegmentLengthCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+WaterTankMuonCherenkovMessenger::~WaterTankMuonCherenkovMessenger()
+{
+  delete fModeCmd;
+  delete fSegmentLengthCmd;
+}
+
+void WaterTankMuonCherenkovMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if (command == fModeCmd) {
+    fModel->SetFastMode(newValue == "fast");
+  }
+  else if (command == fSegmentLengthCmd) {
+    fModel->SetSegmentLength(fSegmentLengthCmd->GetNewDoubleValue(newValue));
+  }
+}
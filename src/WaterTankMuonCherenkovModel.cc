@@ -0,0 +1,278 @@
+/// \file WaterTankMuonCherenkovModel.cc
+/// \brief Implementation of the WaterTankMuonCherenkovModel class
+
+#include "WaterTankMuonCherenkovModel.hh"
+#include "WaterTankMuonCherenkovMessenger.hh"
+#include "WaterTankCherenkov.hh"
+#include "WaterTankDetectorConstruction.hh"
+#include "WaterTankDOMSD.hh"
+#include "WaterTankPropertyTable.hh"
+
+#include "G4FastStep.hh"
+#include "G4FastTrack.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Material.hh"
+#include "G4MaterialPropertiesTable.hh"
+#include "G4MuonMinus.hh"
+#include "G4MuonPlus.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4Poisson.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+  // Photon energy bins used to integrate the Frank-Tamm spectrum.
+  const G4int kEnergyBins = 32;
+  // Shortest step the model takes over; anything shorter is left to Geant4
+  // so the muon can leave the water through normal transport.
+  const G4double kMinimumStep = 1.*um;
+
+  G4double BetaOf(G4double kineticEnergy, G4double mass)
+  {
+    const G4double gamma = 1. + kineticEnergy / mass;
+    return std::sqrt(std::max(0., 1. - 1./(gamma*gamma)));
+  }
+}
+
+WaterTankMuonCherenkovModel::WaterTankMuonCherenkovModel(const G4String& name,
+                                                         G4Region* envelope,
+                                                         const WaterTankDetectorConstruction* detector,
+                                                         WaterTankDOMSD* domSD)
+: G4VFastSimulationModel(name, envelope),
+  fDetector(detector),
+  fDOMSD(domSD),
+  fMessenger(nullptr),
+  fFastMode(false),
+  fSegmentLength(1.*cm),
+  fConfigured(false),
+  fEnergyMin(0.),
+  fEnergyWidth(0.)
+{
+  fMessenger = new WaterTankMuonCherenkovMessenger(this);
+}
+
+WaterTankMuonCherenkovModel::~WaterTankMuonCherenkovModel()
+{
+  delete fMessenger;
+}
+
+G4bool WaterTankMuonCherenkovModel::IsApplicable(const G4ParticleDefinition& particle)
+{
+  return &particle == G4MuonMinus::Definition() || &particle == G4MuonPlus::Definition();
+}
+
+G4bool WaterTankMuonCherenkovModel::ModelTrigger(const G4FastTrack& fastTrack)
+{
+  if (!fFastMode) return false;
+  if (!fConfigured) Configure();
+  if (!fConfigured) return false;
+
+  // The envelope also contains the DOM; only take over muons in the water.
+  const G4Track* track = fastTrack.GetPrimaryTrack();
+  if (!fGeometry.IsInWater(track->GetPosition())) return false;
+  return DistanceInWater(track->GetPosition(), track->GetMomentumDirection()) > kMinimumStep;
+}
+
+void WaterTankMuonCherenkovModel::DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep)
+{
+  const G4Track* track = fastTrack.GetPrimaryTrack();
+  const G4ThreeVector position  = track->GetPosition();
+  const G4ThreeVector direction = track->GetMomentumDirection();
+  const G4double kineticEnergy = track->GetKineticEnergy();
+  const G4ParticleDefinition* particle = track->GetDefinition();
+  const G4double mass   = particle->GetPDGMass();
+  const G4double charge = particle->GetPDGCharge();
+
+  // The muon is in the water: open the readout window before its hits.
+  if (fDOMSD) fDOMSD->MarkWaterEntry(track->GetGlobalTime());
+
+  // Straight-line transport with the mean total energy loss, stopping early
+  // if the muon ranges out in the water.
+  const G4double dEdx
+    = fEmCalculator.ComputeTotalDEDX(kineticEnergy, particle, track->GetMaterial());
+  G4double length = DistanceInWater(position, direction);
+  G4bool stops = false;
+  if (dEdx > 0. && kineticEnergy <= dEdx * length) {
+    length = kineticEnergy / dEdx;
+    stops = true;
+  }
+  const G4double finalEnergy = stops ? 0. : kineticEnergy - dEdx * length;
+  const G4double meanBeta = 0.5 * (BetaOf(kineticEnergy, mass) + BetaOf(finalEnergy, mass));
+  const G4double meanGamma = 1. + 0.5 * (kineticEnergy + finalEnergy) / mass;
+  const G4double duration = meanBeta > 0. ? length / (meanBeta * c_light) : 0.;
+
+  // Cherenkov light, one segment at a time.
+  const G4int nSegments = std::max(1, G4int(std::ceil(length / fSegmentLength)));
+  const G4double segmentLength = length / nSegments;
+  for (G4int i = 0; i < nSegments; ++i) {
+    const G4double s = (i + 0.5) * segmentLength;
+    const G4double energy = std::max(0., kineticEnergy - dEdx * s);
+    GenerateSegmentHits(position + s * direction, direction,
+                        track->GetGlobalTime() + duration * s / length,
+                        BetaOf(energy, mass), charge, segmentLength, track->GetTrackID());
+  }
+
+  fastStep.ProposePrimaryTrackFinalPosition(position + length * direction, false);
+  fastStep.ProposePrimaryTrackFinalMomentumDirection(direction, false);
+  fastStep.ProposePrimaryTrackFinalKineticEnergy(finalEnergy);
+  fastStep.ProposePrimaryTrackFinalTime(track->GetGlobalTime() + duration);
+  fastStep.ProposePrimaryTrackFinalProperTime(track->GetProperTime() + duration / meanGamma);
+  fastStep.ProposePrimaryTrackPathLength(length);
+  fastStep.ProposeTotalEnergyDeposited(kineticEnergy - finalEnergy);
+  if (stops) {
+    // Leave the muon to its at-rest processes (decay or capture).
+    fastStep.ProposeTrackStatus(fStopButAlive);
+  }
+}
+
+void WaterTankMuonCherenkovModel::Configure()
+{
+  if (!fGeometry.Configure(fDetector)) return;
+  if (!fPropagator.Configure(fDetector)) return;
+
+  const G4MaterialPropertiesTable* waterMPT
+    = fDetector->GetWaterLogicalVolume()->GetMaterial()->GetMaterialPropertiesTable();
+  if (!waterMPT || !waterMPT->GetProperty("RINDEX")) return;
+
+  WaterTankPropertyTable refractiveIndex;
+  refractiveIndex.Build(*waterMPT->GetProperty("RINDEX"));
+  WaterTankPropertyTable absorption;
+  if (waterMPT->GetProperty("ABSLENGTH")) absorption.Build(*waterMPT->GetProperty("ABSLENGTH"));
+  WaterTankPropertyTable groupVelocity;
+  if (waterMPT->GetProperty("GROUPVEL")) groupVelocity.Build(*waterMPT->GetProperty("GROUPVEL"));
+
+  fEnergyMin = refractiveIndex.GetMinEnergy();
+  fEnergyWidth = (refractiveIndex.GetMaxEnergy() - fEnergyMin) / kEnergyBins;
+  fRefractiveIndex.resize(kEnergyBins);
+  fAbsorptionLength.resize(kEnergyBins);
+  fGroupVelocity.resize(kEnergyBins);
+  fBinYield.resize(kEnergyBins);
+  for (G4int k = 0; k < kEnergyBins; ++k) {
+    const G4double energy = fEnergyMin + (k + 0.5) * fEnergyWidth;
+    fRefractiveIndex[k] = refractiveIndex.Value(energy);
+    fAbsorptionLength[k] = absorption.IsValid() ? absorption.Value(energy) : DBL_MAX;
+    fGroupVelocity[k] = groupVelocity.IsValid() ? groupVelocity.Value(energy)
+                                                : c_light / fRefractiveIndex[k];
+  }
+  fConfigured = true;
+}
+
+G4double WaterTankMuonCherenkovModel::DistanceInWater(const G4ThreeVector& position,
+                                                      const G4ThreeVector& direction) const
+{
+  return std::min(fGeometry.DistanceToWall(position, direction),
+                  fGeometry.DistanceToDOM(position, direction));
+}
+
+void WaterTankMuonCherenkovModel::GenerateSegmentHits(const G4ThreeVector& position,
+                                                      const G4ThreeVector& direction,
+                                                      G4double time, G4double beta,
+                                                      G4double charge, G4double length,
+                                                      G4int parentID)
+{
+  if (!fDOMSD || beta <= 0. || charge == 0.) return;
+
+  const G4ThreeVector offset = fGeometry.GetDOMCenter() - position;
+  const G4double distance = offset.mag();
+  const G4double radius = fGeometry.GetDOMRadius();
+  if (distance <= radius) return;
+
+  // Frame around the track: e1 points from the track towards the DOM, so the
+  // cone azimuth phi = 0 is the direction closest to the DOM center.
+  const G4ThreeVector toDOM = offset / distance;
+  const G4double cosPsi = direction.dot(toDOM);
+  const G4double sinPsi = std::sqrt(std::max(0., 1. - cosPsi*cosPsi));
+  const G4ThreeVector e1 = sinPsi > 1.e-9 ? (toDOM - cosPsi * direction) / sinPsi
+                                          : direction.orthogonal().unit();
+  const G4ThreeVector e2 = direction.cross(e1);
+  // A direction hits the DOM if its angle to toDOM is below asin(R/D).
+  const G4double cosAlpha = std::sqrt(1. - (radius*radius) / (distance*distance));
+
+  const G4double betaInverse = 1. / beta;
+  const G4double chargeRatio = charge / eplus;
+  const G4double yieldScale
+    = WaterTankCherenkov::kYield * chargeRatio*chargeRatio * length * fEnergyWidth;
+
+  // Expected photons reaching the DOM per energy bin: Frank-Tamm yield times
+  // the fraction of the cone azimuth that intersects the DOM and absorption
+  // to the DOM surface.
+  G4double total = 0.;
+  for (G4int k = 0; k < kEnergyBins; ++k) {
+    fBinYield[k] = 0.;
+    const G4double cosTheta = betaInverse / fRefractiveIndex[k];
+    if (cosTheta >= 1.) continue;
+    const G4double sin2Theta = (1. - cosTheta) * (1. + cosTheta);
+    const G4double halfArc = ConeHalfArc(cosTheta, std::sqrt(sin2Theta), cosPsi, sinPsi, cosAlpha);
+    if (halfArc <= 0.) continue;
+    fBinYield[k] = yieldScale * sin2Theta * (halfArc / pi)
+                 * std::exp(-(distance - radius) / fAbsorptionLength[k]);
+    total += fBinYield[k];
+  }
+  if (total <= 0.) return;
+
+  const G4long nArrivals = G4Poisson(total);
+  for (G4long i = 0; i < nArrivals; ++i) {
+    // Energy bin in proportion to its expected arrivals.
+    G4double pick = G4UniformRand() * total;
+    G4int k = 0;
+    while (k < kEnergyBins - 1 && pick >= fBinYield[k]) {
+      pick -= fBinYield[k];
+      ++k;
+    }
+
+    // Emission azimuth uniform over the arc of the cone that meets the DOM.
+    const G4double cosTheta = betaInverse / fRefractiveIndex[k];
+    const G4double sinTheta = std::sqrt((1. - cosTheta) * (1. + cosTheta));
+    const G4double halfArc = ConeHalfArc(cosTheta, sinTheta, cosPsi, sinPsi, cosAlpha);
+    const G4double phi = (2. * G4UniformRand() - 1.) * halfArc;
+    const G4ThreeVector photonDirection
+      = cosTheta * direction + sinTheta * (std::cos(phi) * e1 + std::sin(phi) * e2);
+
+    const G4double pathLength = fGeometry.DistanceToDOM(position, photonDirection);
+    if (pathLength == DBL_MAX) continue;  // grazing the rim, lost to rounding
+
+    WaterTankPhotonPropagator::Photon photon;
+    photon.position  = position + pathLength * photonDirection;
+    photon.direction = photonDirection;
+    photon.time      = time + pathLength / fGroupVelocity[k];
+    photon.energy    = fEnergyMin + (k + G4UniformRand()) * fEnergyWidth;
+    SampleDOMSurface(photon, parentID);
+  }
+}
+
+void WaterTankMuonCherenkovModel::SampleDOMSurface(WaterTankPhotonPropagator::Photon& photon,
+                                                   G4int parentID)
+{
+  // Same sequence as the dielectric_metal boundary during tracking and the
+  // analytic propagation: detect with the DOM efficiency, otherwise reflect
+  // with the surface reflectivity or be absorbed with 1 - REFLECTIVITY. A
+  // reflected photon is ray-traced on and may come back after scattering.
+  // The absolute efficiency is used: no photon was thinned at emission, so
+  // the QE-first scale does not apply.
+  do {
+    if (fDOMSD->SampleDetection(fDOMSD->GetEfficiency(photon.energy))) {
+      fDOMSD->AddHit(photon.time, photon.position, photon.direction, photon.energy, 0, parentID);
+      return;
+    }
+  } while (fPropagator.ReflectOffDOM(photon) && fPropagator.TransportToDOM(photon));
+}
+
+G4double WaterTankMuonCherenkovModel::ConeHalfArc(G4double cosTheta, G4double sinTheta,
+                                                  G4double cosPsi, G4double sinPsi,
+                                                  G4double cosAlpha)
+{
+  // Cone direction at azimuth phi makes an angle with the DOM direction of
+  //   cos = cosTheta cosPsi + sinTheta sinPsi cos(phi),
+  // so it hits the DOM for |phi| below the half arc returned here.
+  const G4double denominator = sinTheta * sinPsi;
+  if (denominator < 1.e-12) {
+    return (cosTheta * cosPsi > cosAlpha) ? pi : 0.;
+  }
+  const G4double cosPhiMax = (cosAlpha - cosTheta * cosPsi) / denominator;
+  return std::acos(std::min(1., std::max(-1., cosPhiMax)));
+}
@@ -0,0 +1,160 @@
+/// \file WaterTankNtupleOutput.cc
+/// \brief Implementation of the WaterTankNtupleOutput class
+
+#include "WaterTankNtupleOutput.hh"
+
+WaterTankNtupleOutput::WaterTankNtupleOutput()
+: fAnalysisManager(G4AnalysisManager::Instance()),
+  fFormat(kRootFormat),
+  fQueueCapacity(0)
+{}
+
+WaterTankNtupleOutput::~WaterTankNtupleOutput()
+{
+  // Stop the writer thread before the backends it uses go away.
+  fQueue.reset();
+}
+
+void WaterTankNtupleOutput::StartQueue()
+{
+  if (fQueue || !Queues()) return;
+  fQueue.reset(new WaterTankOutputQueue(std::size_t(fQueueCapacity),
+                                        [this](WaterTankOutputRecord& record) { Replay(record); }));
+}
+
+G4int WaterTankNtupleOutput::CreateNtuple(const G4String& name, const G4String& title)
+{
+  G4int id = 0;
+  if (WritesRoot()) id = fAnalysisManager->CreateNtuple(name, title);
+  if (WritesColumnar()) id = fColumnar.CreateNtuple(name, title);
+  fBindings.resize(id + 1);
+  return id;
+}
+
+void WaterTankNtupleOutput::CreateNtupleIColumn(const G4String& name)
+{
+  if (WritesRoot()) fAnalysisManager->CreateNtupleIColumn(name);
+  if (WritesColumnar()) fColumnar.CreateNtupleIColumn(name);
+}
+
+void WaterTankNtupleOutput::CreateNtupleFColumn(const G4String& name)
+{
+  if (WritesRoot()) fAnalysisManager->CreateNtupleFColumn(name);
+  if (WritesColumnar()) fColumnar.CreateNtupleFColumn(name);
+}
+
+void WaterTankNtupleOutput::CreateNtupleDColumn(const G4String& name)
+{
+  if (WritesRoot()) fAnalysisManager->CreateNtupleDColumn(name);
+  if (WritesColumnar()) fColumnar.CreateNtupleDColumn(name);
+}
+
+void WaterTankNtupleOutput::CreateNtupleIColumn(const G4String& name, std::vector<G4int>& vector)
+{
+  std::vector<G4int>* bound = &vector;
+  if (Queues()) {
+    fBoundInts.emplace_back();
+    bound = &fBoundInts.back();
+  }
+  fBindings.back().ints.emplace_back(&vector, bound);
+  if (WritesRoot()) fAnalysisManager->CreateNtupleIColumn(name, vector);
+  if (WritesColumnar()) fColumnar.CreateNtupleIColumn(name, *bound);
+}
+
+void WaterTankNtupleOutput::CreateNtupleFColumn(const G4String& name, std::vector<float>& vector)
+{
+  std::vector<float>* bound = &vector;
+  if (Queues()) {
+    fBoundFloats.emplace_back();
+    bound = &fBoundFloats.back();
+  }
+  fBindings.back().floats.emplace_back(&vector, bound);
+  if (WritesRoot()) fAnalysisManager->CreateNtupleFColumn(name, vector);
+  if (WritesColumnar()) fColumnar.CreateNtupleFColumn(name, *bound);
+}
+
+void WaterTankNtupleOutput::FinishNtuple()
+{
+  if (WritesRoot()) fAnalysisManager->FinishNtuple();
+  if (WritesColumnar()) fColumnar.FinishNtuple();
+}
+
+void WaterTankNtupleOutput::SetNtupleActivation(G4int id, G4bool active)
+{
+  Drain();
+  if (WritesRoot()) fAnalysisManager->SetNtupleActivation(id, active);
+  if (WritesColumnar()) fColumnar.SetNtupleActivation(id, active);
+}
+
+void WaterTankNtupleOutput::OpenFile(const G4String& rootName, const G4String& columnarName)
+{
+  Drain();
+  if (WritesRoot()) fAnalysisManager->OpenFile(rootName);
+  if (WritesColumnar() && !columnarName.empty()) fColumnar.OpenFile(columnarName);
+}
+
+void WaterTankNtupleOutput::CloseFile()
+{
+  Drain();
+  if (WritesRoot()) {
+    fAnalysisManager->Write();
+    fAnalysisManager->CloseFile();
+  }
+  if (fColumnar.IsOpen()) fColumnar.CloseFile();
+}
+
+void WaterTankNtupleOutput::AddNtupleRow(G4int id)
+{
+  if (WritesRoot()) fAnalysisManager->AddNtupleRow(id);
+  if (!fQueue) {
+    if (WritesColumnar()) fColumnar.AddNtupleRow(id);
+    return;
+  }
+  // Copy the vector columns into the record's reusable storage.
+  WaterTankOutputRecord& record = fQueue->Current();
+  for (const auto& binding : fBindings[id].ints) {
+    if (record.nIntVectors == record.intVectors.size()) record.intVectors.emplace_back();
+    record.intVectors[record.nIntVectors++].assign(binding.first->begin(), binding.first->end());
+  }
+  for (const auto& binding : fBindings[id].floats) {
+    if (record.nFloatVectors == record.floatVectors.size()) record.floatVectors.emplace_back();
+    record.floatVectors[record.nFloatVectors++].assign(binding.first->begin(), binding.first->end());
+  }
+  Record(WaterTankOutputRecord::kAddRow, id, 0);
+}
+
+void WaterTankNtupleOutput::SubmitEvent()
+{
+  if (fQueue && !fQueue->Current().operations.empty()) fQueue->Submit();
+}
+
+void WaterTankNtupleOutput::Replay(WaterTankOutputRecord& record)
+{
+  // Runs on the writer thread, so only the columnar writer is used here.
+  // Swapping hands the recorded vectors to the bound ones without copying;
+  // the record keeps the old storage for reuse.
+  std::size_t nInts = 0;
+  std::size_t nFloats = 0;
+  for (const auto& operation : record.operations) {
+    switch (operation.kind) {
+      case WaterTankOutputRecord::kFillI:
+        fColumnar.FillNtupleIColumn(operation.ntuple, operation.column, operation.value.i);
+        break;
+      case WaterTankOutputRecord::kFillF:
+        fColumnar.FillNtupleFColumn(operation.ntuple, operation.column, operation.value.f);
+        break;
+      case WaterTankOutputRecord::kFillD:
+        fColumnar.FillNtupleDColumn(operation.ntuple, operation.column, operation.value.d);
+        break;
+      case WaterTankOutputRecord::kAddRow:
+        for (const auto& binding : fBindings[operation.ntuple].ints) {
+          binding.second->swap(record.intVectors[nInts++]);
+        }
+        for (const auto& binding : fBindings[operation.ntuple].floats) {
+          binding.second->swap(record.floatVectors[nFloats++]);
+        }
+        fColumnar.AddNtupleRow(operation.ntuple);
+        break;
+    }
+  }
+}
@@ -0,0 +1,99 @@
+/// \file WaterTankOpticalGeometry.cc
+/// \brief Implementation of the WaterTankOpticalGeometry class
+
+#include "WaterTankOpticalGeometry.hh"
+#include "WaterTankDetectorConstruction.hh"
+
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4Tubs.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+WaterTankOpticalGeometry::WaterTankOpticalGeometry()
+: fConfigured(false),
+  fTankRadius(0.),
+  fTankHalfHeight(0.),
+  fDOMCenter(),
+  fDOMRadius(0.)
+{}
+
+WaterTankOpticalGeometry::~WaterTankOpticalGeometry()
+{}
+
+G4bool WaterTankOpticalGeometry::Configure(const WaterTankDetectorConstruction* detector)
+{
+  fConfigured = false;
+  if (!detector) return false;
+
+  const G4LogicalVolume* waterLV = detector->GetWaterLogicalVolume();
+  const G4VPhysicalVolume* waterPV = detector->GetWaterPhysicalVolume();
+  const G4VPhysicalVolume* domPV = detector->GetDOMPhysicalVolume();
+  if (!waterLV || !waterPV || !domPV) return false;
+
+  auto waterSolid = dynamic_cast<const G4Tubs*>(waterLV->GetSolid());
+  if (!waterSolid) return false;
+
+  fTankRadius     = waterSolid->GetOuterRadius();
+  fTankHalfHeight = waterSolid->GetZHalfLength();
+  // Neither placement is rotated, so the DOM center is the sum of offsets.
+  fDOMCenter      = waterPV->GetTranslation() + domPV->GetTranslation();
+  fDOMRadius      = detector->GetDOMRadius();
+  fConfigured     = true;
+  return true;
+}
+
+G4double WaterTankOpticalGeometry::DistanceToDOM(const G4ThreeVector& pos,
+                                                 const G4ThreeVector& dir) const
+{
+  const G4ThreeVector offset = pos - fDOMCenter;
+  const G4double b = offset.dot(dir);
+  const G4double c = offset.mag2() - fDOMRadius*fDOMRadius;
+  if (c <= 0.) return 0.;
+
+  // Outside the sphere: a hit needs the ray to point towards the center and
+  // the closest approach to fall within the radius.
+  const G4double disc = b*b - c;
+  if (b >= 0. || disc < 0.) return DBL_MAX;
+  return -b - std::sqrt(disc);
+}
+
+G4double WaterTankOpticalGeometry::DistanceToWall(const G4ThreeVector& pos,
+                                                  const G4ThreeVector& dir) const
+{
+  G4double distance = DBL_MAX;
+
+  // Barrel: solve |p_xy + t d_xy| = R for the positive root.
+  const G4double a = dir.x()*dir.x() + dir.y()*dir.y();
+  if (a > 0.) {
+    const G4double b = pos.x()*dir.x() + pos.y()*dir.y();
+    const G4double c = pos.x()*pos.x() + pos.y()*pos.y() - fTankRadius*fTankRadius;
+    const G4double disc = std::max(0., b*b - a*c);
+    distance = std::max(0., (-b + std::sqrt(disc)) / a);
+  }
+
+  // End caps.
+  if (dir.z() > 0.) {
+    distance = std::min(distance, std::max(0., (fTankHalfHeight - pos.z()) / dir.z()));
+  } else if (dir.z() < 0.) {
+    distance = std::min(distance, std::max(0., (-fTankHalfHeight - pos.z()) / dir.z()));
+  }
+  return distance;
+}
+
+G4double WaterTankOpticalGeometry::DOMSolidAngleFraction(const G4ThreeVector& pos) const
+{
+  const G4double d2 = (pos - fDOMCenter).mag2();
+  const G4double r2 = fDOMRadius*fDOMRadius;
+  if (d2 <= r2) return 1.;
+  return 0.5 * (1. - std::sqrt(1. - r2/d2));
+}
+
+G4bool WaterTankOpticalGeometry::IsInWater(const G4ThreeVector& pos) const
+{
+  if (std::abs(pos.z()) > fTankHalfHeight) return false;
+  if (pos.perp2() > fTankRadius*fTankRadius) return false;
+  return (pos - fDOMCenter).mag2() > fDOMRadius*fDOMRadius;
+}
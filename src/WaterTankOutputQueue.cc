@@ -0,0 +1,104 @@
+/// \file WaterTankOutputQueue.cc
+/// \brief Implementation of the WaterTankOutputQueue class
+
+#include "WaterTankOutputQueue.hh"
+
+#include <chrono>
+
+WaterTankOutputQueue::WaterTankOutputQueue(std::size_t capacity, Consumer consumer)
+: fConsumer(std::move(consumer)),
+  fCurrent(nullptr),
+  fFull(capacity),
+  fFree(capacity + 2),
+  fSubmitted(0),
+  fConsumed(0),
+  fStop(false),
+  fSubmittedSinceReset(0),
+  fDepthSum(0.),
+  fMaxDepth(0),
+  fStalls(0),
+  fStallSeconds(0.)
+{
+  fRecords.emplace_back(new WaterTankOutputRecord);
+  fCurrent = fRecords.back().get();
+  fThread = std::thread(&WaterTankOutputQueue::WriterLoop, this);
+}
+
+WaterTankOutputQueue::~WaterTankOutputQueue()
+{
+  Drain();
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fStop.store(true, std::memory_order_release);
+  }
+  fWork.notify_one();
+  fThread.join();
+}
+
+void WaterTankOutputQueue::Submit()
+{
+  if (!fFull.Push(fCurrent)) {
+    // Backpressure: the writer thread is behind by a full queue.
+    const auto start = std::chrono::steady_clock::now();
+    {
+      std::unique_lock<std::mutex> lock(fMutex);
+      fDone.wait(lock, [this] { return fFull.Size() < fFull.Capacity(); });
+    }
+    fFull.Push(fCurrent);
+    ++fStalls;
+    fStallSeconds += std::chrono::duration<G4double>(std::chrono::steady_clock::now() - start).count();
+  }
+  // Taking the lock orders the push before the writer thread's check of the
+  // ring, so the notification cannot be lost.
+  { std::lock_guard<std::mutex> lock(fMutex); }
+  fWork.notify_one();
+  ++fSubmitted;
+  ++fSubmittedSinceReset;
+  const G4int depth = G4int(fFull.Size());
+  fDepthSum += depth;
+  if (depth > fMaxDepth) fMaxDepth = depth;
+
+  // Reuse a consumed record; a new one is only needed while the queue
+  // fills up for the first time.
+  if (!fFree.Pop(fCurrent)) {
+    fRecords.emplace_back(new WaterTankOutputRecord);
+    fCurrent = fRecords.back().get();
+  }
+  fCurrent->Clear();
+}
+
+void WaterTankOutputQueue::Drain()
+{
+  std::unique_lock<std::mutex> lock(fMutex);
+  fDone.wait(lock, [this] { return fConsumed.load(std::memory_order_acquire) == fSubmitted; });
+}
+
+void WaterTankOutputQueue::ResetStatistics()
+{
+  fSubmittedSinceReset = 0;
+  fDepthSum = 0.;
+  fMaxDepth = 0;
+  fStalls = 0;
+  fStallSeconds = 0.;
+}
+
+void WaterTankOutputQueue::WriterLoop()
+{
+  WaterTankOutputRecord* record = nullptr;
+  while (true) {
+    if (!fFull.Pop(record)) {
+      std::unique_lock<std::mutex> lock(fMutex);
+      fWork.wait(lock, [this] { return fFull.Size() > 0 || fStop.load(std::memory_order_acquire); });
+      if (fFull.Size() == 0) break;
+      continue;
+    }
+    fConsumer(*record);
+    // The free ring holds every record that is not queued or current.
+    fFree.Push(record);
+    {
+      std::lock_guard<std::mutex> lock(fMutex);
+      fConsumed.fetch_add(1, std::memory_order_release);
+    }
+    fDone.notify_one();
+  }
+}
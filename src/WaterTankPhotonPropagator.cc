@@ -0,0 +1,138 @@
+/// \file WaterTankPhotonPropagator.cc
+/// \brief Implementation of the WaterTankPhotonPropagator class
+
+#include "WaterTankPhotonPropagator.hh"
+#include "WaterTankDetectorConstruction.hh"
+
+#include "G4LogicalVolume.hh"
+#include "G4Material.hh"
+#include "G4MaterialPropertiesTable.hh"
+#include "G4OpticalSurface.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+  // Distance a reflected photon is pushed off the DOM surface so that the
+  // next intersection test does not find it still on the sphere.
+  const G4double kSurfacePush = 1.*nm;
+}
+
+WaterTankPhotonPropagator::WaterTankPhotonPropagator()
+: fConfigured(false),
+  fMaxInteractions(1000)
+{}
+
+WaterTankPhotonPropagator::~WaterTankPhotonPropagator()
+{}
+
+G4bool WaterTankPhotonPropagator::Configure(const WaterTankDetectorConstruction* detector)
+{
+  fConfigured = false;
+  if (!fGeometry.Configure(detector)) return false;
+
+  const G4Material* water = detector->GetWaterLogicalVolume()->GetMaterial();
+  const G4MaterialPropertiesTable* waterMPT = water->GetMaterialPropertiesTable();
+  if (!waterMPT) return false;
+
+  auto refractiveIndex = waterMPT->GetProperty("RINDEX");
+  if (!refractiveIndex) return false;
+  fRefractiveIndex.Build(*refractiveIndex);
+
+  fGroupVelocity.Clear();
+  if (auto groupVelocity = waterMPT->GetProperty("GROUPVEL")) {
+    fGroupVelocity.Build(*groupVelocity);
+  }
+  fAbsorptionLength.Clear();
+  if (auto absorption = waterMPT->GetProperty("ABSLENGTH")) {
+    fAbsorptionLength.Build(*absorption);
+  }
+  fRayleighLength.Clear();
+  if (auto rayleigh = waterMPT->GetProperty("RAYLEIGH")) {
+    fRayleighLength.Build(*rayleigh);
+  }
+
+  fDOMReflectivity.Clear();
+  const G4OpticalSurface* domSurface = detector->GetDOMOpticalSurface();
+  if (domSurface && domSurface->GetMaterialPropertiesTable()) {
+    if (auto reflectivity = domSurface->GetMaterialPropertiesTable()->GetProperty("REFLECTIVITY")) {
+      fDOMReflectivity.Build(*reflectivity);
+    }
+  }
+
+  fConfigured = true;
+  return true;
+}
+
+G4double WaterTankPhotonPropagator::GetGroupVelocity(G4double energy) const
+{
+  if (fGroupVelocity.IsValid()) {
+    return fGroupVelocity.Value(energy);
+  }
+  return c_light / fRefractiveIndex.Value(energy);
+}
+
+G4bool WaterTankPhotonPropagator::TransportToDOM(Photon& photon) const
+{
+  // The optical tables do not depend on position, so look them up once.
+  const G4double absorptionLength
+    = fAbsorptionLength.IsValid() ? fAbsorptionLength.Value(photon.energy) : DBL_MAX;
+  const G4double rayleighLength
+    = fRayleighLength.IsValid() ? fRayleighLength.Value(photon.energy) : DBL_MAX;
+  const G4double velocity = GetGroupVelocity(photon.energy);
+
+  for (G4int interaction = 0; interaction < fMaxInteractions; ++interaction) {
+    // Exponential path lengths are memoryless, so both can be re-drawn after
+    // every scatter without biasing the distributions.
+    const G4double toAbsorption = -absorptionLength * std::log(G4UniformRand());
+    const G4double toScatter    = -rayleighLength * std::log(G4UniformRand());
+    const G4double toDOM  = fGeometry.DistanceToDOM(photon.position, photon.direction);
+    const G4double toWall = fGeometry.DistanceToWall(photon.position, photon.direction);
+
+    const G4double step = std::min(std::min(toAbsorption, toScatter), std::min(toDOM, toWall));
+    photon.position += step * photon.direction;
+    photon.time     += step / velocity;
+
+    if (step == toDOM) return true;
+    if (step == toAbsorption || step == toWall) return false;
+
+    photon.direction = SampleRayleighDirection(photon.direction);
+  }
+  return false;
+}
+
+G4bool WaterTankPhotonPropagator::ReflectOffDOM(Photon& photon) const
+{
+  const G4double reflectivity
+    = fDOMReflectivity.IsValid() ? fDOMReflectivity.Value(photon.energy) : 1.;
+  if (G4UniformRand() >= reflectivity) return false;
+
+  // Polished surface: mirror the direction about the outward normal and step
+  // just outside the sphere.
+  const G4ThreeVector normal = (photon.position - fGeometry.GetDOMCenter()).unit();
+  photon.direction -= 2. * photon.direction.dot(normal) * normal;
+  photon.position = fGeometry.GetDOMCenter()
+                  + (fGeometry.GetDOMRadius() + kSurfacePush) * normal;
+  return true;
+}
+
+G4ThreeVector
+WaterTankPhotonPropagator::SampleRayleighDirection(const G4ThreeVector& direction) const
+{
+  // Invert the CDF of p(c) ~ 1 + c^2 on [-1, 1]: c^3 + 3c = 8u - 4, solved
+  // with Cardano's formula for the single real root.
+  const G4double q = 4. * G4UniformRand() - 2.;
+  const G4double root = std::sqrt(q*q + 1.);
+  const G4double cosTheta = std::cbrt(q + root) + std::cbrt(q - root);
+  const G4double sinTheta = std::sqrt(std::max(0., 1. - cosTheta*cosTheta));
+  const G4double phi = twopi * G4UniformRand();
+
+  G4ThreeVector scattered(sinTheta*std::cos(phi), sinTheta*std::sin(phi), cosTheta);
+  scattered.rotateUz(direction);
+  return scattered;
+}
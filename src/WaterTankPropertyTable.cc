@@ -0,0 +1,94 @@
+/// \file WaterTankPropertyTable.cc
+/// \brief Implementation of the WaterTankPropertyTable class
+
+#include "WaterTankPropertyTable.hh"
+
+#include "G4PhysicsVector.hh"
+
+#include <cmath>
+
+WaterTankPropertyTable::WaterTankPropertyTable()
+: fMinEnergy(0.),
+  fMaxEnergy(0.),
+  fFirstValue(0.),
+  fLastValue(0.),
+  fMaxValue(0.),
+  fInvCellWidth(0.)
+{}
+
+WaterTankPropertyTable::~WaterTankPropertyTable()
+{}
+
+void WaterTankPropertyTable::Clear()
+{
+  fNodes.clear();
+  fEnergies.clear();
+  fCellToNode.clear();
+  fMinEnergy = fMaxEnergy = 0.;
+  fFirstValue = fLastValue = fMaxValue = 0.;
+  fInvCellWidth = 0.;
+}
+
+void WaterTankPropertyTable::Build(const G4PhysicsVector& vector)
+{
+  Clear();
+
+  const std::size_t nNodes = vector.GetVectorLength();
+  if (nNodes == 0) return;
+
+  for (std::size_t i = 0; i < nNodes; ++i) {
+    fEnergies.push_back(vector.Energy(i));
+  }
+  fFirstValue = vector[0];
+  fLastValue  = vector[nNodes - 1];
+  fMinEnergy  = fEnergies.front();
+  fMaxEnergy  = fEnergies.back();
+
+  fMaxValue = fFirstValue;
+  for (std::size_t i = 0; i < nNodes; ++i) {
+    fMaxValue = std::max(fMaxValue, vector[i]);
+  }
+
+  // A single-node curve is constant. Give it a dummy second node so the
+  // interpolation arithmetic stays uniform (deltaValue = 0).
+  if (nNodes == 1) {
+    fEnergies.push_back(fMinEnergy + 1.);
+    fNodes.push_back({fMinEnergy, 1., fFirstValue, 0.});
+    fCellToNode.assign(1, 0);
+    fInvCellWidth = 0.;
+    return;
+  }
+
+  // Interpolation intervals, using exactly the differences that
+  // G4PhysicsVector::Interpolation forms at run time.
+  G4double minSpacing = fMaxEnergy - fMinEnergy;
+  for (std::size_t i = 0; i + 1 < nNodes; ++i) {
+    const G4double x1 = fEnergies[i];
+    const G4double dl = fEnergies[i + 1] - x1;
+    const G4double y1 = vector[i];
+    const G4double dy = vector[i + 1] - y1;
+    fNodes.push_back({x1, dl, y1, dy});
+    minSpacing = std::min(minSpacing, dl);
+  }
+
+  // Uniform index cells at half the smallest node spacing, so no cell can hold
+  // more than one node.
+  fInvCellWidth = 2. / minSpacing;
+  auto cellOf = [this](G4double e) {
+    return static_cast<std::size_t>((e - fMinEnergy) * fInvCellWidth);
+  };
+  const std::size_t nCells = cellOf(fMaxEnergy) + 1;
+
+  // For each cell store the last interval whose lower node maps to an earlier
+  // cell. Node cells are computed with the same expression Value() uses, so the
+  // rounding of the cell index can never put an energy on the wrong side.
+  const std::size_t lastInterval = fNodes.size() - 1;
+  fCellToNode.resize(nCells);
+  std::size_t idx = 0;
+  for (std::size_t cell = 0; cell < nCells; ++cell) {
+    while (idx < lastInterval && cellOf(fEnergies[idx + 1]) < cell) {
+      ++idx;
+    }
+    fCellToNode[cell] = idx;
+  }
+}
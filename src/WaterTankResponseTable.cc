@@ -0,0 +1,240 @@
+/// \file WaterTankResponseTable.cc
+/// \brief Implementation of the WaterTankResponseTable class
+
+#include "WaterTankResponseTable.hh"
+
+#include "G4ios.hh"
+#include "G4PhysicalConstants.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+  const char kMagic[8] = {'W', 'T', 'R', 'E', 'S', 'P', '\0', '\0'};
+  const std::uint32_t kVersion = 1;
+
+  /// On-disk header. All members are fixed width and the size is a multiple
+  /// of 8, so the float arrays that follow stay aligned when mapped.
+  struct FileHeader {
+    char          magic[8];
+    std::uint32_t version;
+    std::int32_t  nR, nZ, nCos, nPhi, nEnergy, nTime;
+    std::uint32_t padding;
+    double        rMax, zMin, zMax, energyMin, energyMax, timeMax;
+    double        domCenterZ, domRadius;
+    std::int64_t  photonsPerCell;
+  };
+  static_assert(sizeof(FileHeader) % 8 == 0, "response table header must keep floats aligned");
+
+  G4int BinOf(G4double value, G4double min, G4double max, G4int nBins)
+  {
+    const G4int bin = G4int((value - min) / (max - min) * nBins);
+    return std::min(std::max(bin, 0), nBins - 1);
+  }
+}
+
+WaterTankResponseTable::WaterTankResponseTable()
+: fBinning(),
+  fDOMCenterZ(0.),
+  fDOMRadius(0.),
+  fPhotonsPerCell(0),
+  fArrival(nullptr),
+  fTimeCDF(nullptr),
+  fMapping(nullptr),
+  fMappingSize(0)
+{}
+
+WaterTankResponseTable::~WaterTankResponseTable()
+{
+  Unmap();
+}
+
+void WaterTankResponseTable::Allocate(const Binning& binning, G4double domCenterZ,
+                                      G4double domRadius, G4long photonsPerCell)
+{
+  Clear();
+  fBinning = binning;
+  fDOMCenterZ = domCenterZ;
+  fDOMRadius = domRadius;
+  fPhotonsPerCell = photonsPerCell;
+
+  const std::size_t cells = NumberOfDirectionCells();
+  fStorage.assign(cells * (binning.nEnergy + binning.nTime), 0.f);
+  fArrival = fStorage.data();
+  fTimeCDF = fStorage.data() + cells * binning.nEnergy;
+}
+
+G4bool WaterTankResponseTable::Write(const G4String& fileName) const
+{
+  if (fStorage.empty()) return false;
+
+  FileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version   = kVersion;
+  header.nR        = fBinning.nR;
+  header.nZ        = fBinning.nZ;
+  header.nCos      = fBinning.nCos;
+  header.nPhi      = fBinning.nPhi;
+  header.nEnergy   = fBinning.nEnergy;
+  header.nTime     = fBinning.nTime;
+  header.rMax      = fBinning.rMax;
+  header.zMin      = fBinning.zMin;
+  header.zMax      = fBinning.zMax;
+  header.energyMin = fBinning.energyMin;
+  header.energyMax = fBinning.energyMax;
+  header.timeMax   = fBinning.timeMax;
+  header.domCenterZ = fDOMCenterZ;
+  header.domRadius  = fDOMRadius;
+  header.photonsPerCell = fPhotonsPerCell;
+
+  std::ofstream out(fileName, std::ios::binary);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(fStorage.data()),
+            std::streamsize(fStorage.size() * sizeof(float)));
+  return bool(out);
+}
+
+G4bool WaterTankResponseTable::Load(const G4String& fileName)
+{
+  Clear();
+
+  const int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) {
+    G4ExceptionDescription msg;
+    msg << "Cannot open DOM response table " << fileName;
+    G4Exception("WaterTankResponseTable::Load()", "RespTable001", JustWarning, msg);
+    return false;
+  }
+
+  struct stat info;
+  void* mapping = MAP_FAILED;
+  if (fstat(fd, &info) == 0 && std::size_t(info.st_size) >= sizeof(FileHeader)) {
+    mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    G4ExceptionDescription msg;
+    msg << "Cannot map DOM response table " << fileName;
+    G4Exception("WaterTankResponseTable::Load()", "RespTable002", JustWarning, msg);
+    return false;
+  }
+  fMapping = mapping;
+  fMappingSize = info.st_size;
+
+  const auto header = static_cast<const FileHeader*>(fMapping);
+  const std::size_t cells = std::size_t(std::max(header->nR, 0)) * std::max(header->nZ, 0)
+                          * std::max(header->nCos, 0) * std::max(header->nPhi, 0);
+  const std::size_t expected = sizeof(FileHeader)
+    + cells * (std::size_t(std::max(header->nEnergy, 0)) + std::max(header->nTime, 0)) * sizeof(float);
+  if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0
+      || header->version != kVersion || cells == 0
+      || header->nEnergy <= 0 || header->nTime <= 0 || fMappingSize != expected) {
+    G4ExceptionDescription msg;
+    msg << fileName << " is not a valid DOM response table (version " << kVersion << ")";
+    G4Exception("WaterTankResponseTable::Load()", "RespTable003", JustWarning, msg);
+    Unmap();
+    return false;
+  }
+
+  fBinning.nR        = header->nR;
+  fBinning.nZ        = header->nZ;
+  fBinning.nCos      = header->nCos;
+  fBinning.nPhi      = header->nPhi;
+  fBinning.nEnergy   = header->nEnergy;
+  fBinning.nTime     = header->nTime;
+  fBinning.rMax      = header->rMax;
+  fBinning.zMin      = header->zMin;
+  fBinning.zMax      = header->zMax;
+  fBinning.energyMin = header->energyMin;
+  fBinning.energyMax = header->energyMax;
+  fBinning.timeMax   = header->timeMax;
+  fDOMCenterZ        = header->domCenterZ;
+  fDOMRadius         = header->domRadius;
+  fPhotonsPerCell    = header->photonsPerCell;
+  fFileName          = fileName;
+
+  fArrival = reinterpret_cast<const float*>(static_cast<const char*>(fMapping) + sizeof(FileHeader));
+  fTimeCDF = fArrival + cells * fBinning.nEnergy;
+  return true;
+}
+
+void WaterTankResponseTable::Clear()
+{
+  Unmap();
+  fStorage.clear();
+  fStorage.shrink_to_fit();
+  fArrival = nullptr;
+  fTimeCDF = nullptr;
+  fFileName = "";
+}
+
+void WaterTankResponseTable::Unmap()
+{
+  if (fMapping) {
+    munmap(fMapping, fMappingSize);
+    fMapping = nullptr;
+    fMappingSize = 0;
+    fArrival = nullptr;
+    fTimeCDF = nullptr;
+  }
+}
+
+std::size_t WaterTankResponseTable::FindDirectionCell(const G4ThreeVector& position,
+                                                      const G4ThreeVector& direction) const
+{
+  const G4double r = position.perp();
+  const G4int iR   = BinOf(r, 0., fBinning.rMax, fBinning.nR);
+  const G4int iZ   = BinOf(position.z(), fBinning.zMin, fBinning.zMax, fBinning.nZ);
+  const G4int iCos = BinOf(direction.z(), -1., 1., fBinning.nCos);
+
+  // Azimuth of the direction relative to the outward radial direction. On the
+  // axis every azimuth is equivalent, so any reference will do.
+  G4double phi = 0.;
+  if (r > 0.) {
+    const G4double radialX = position.x() / r;
+    const G4double radialY = position.y() / r;
+    const G4double along  = direction.x()*radialX + direction.y()*radialY;
+    const G4double across = direction.y()*radialX - direction.x()*radialY;
+    phi = std::fabs(std::atan2(across, along));
+  }
+  const G4int iPhi = BinOf(phi, 0., pi, fBinning.nPhi);
+
+  return DirectionCell(iR, iZ, iCos, iPhi);
+}
+
+G4double WaterTankResponseTable::GetArrivalProbability(const G4ThreeVector& position,
+                                                       const G4ThreeVector& direction,
+                                                       G4double energy) const
+{
+  if (!fArrival) return 0.;
+  const std::size_t cell = FindDirectionCell(position, direction);
+  const G4int iEnergy = BinOf(energy, fBinning.energyMin, fBinning.energyMax, fBinning.nEnergy);
+  return fArrival[cell*fBinning.nEnergy + iEnergy];
+}
+
+G4double WaterTankResponseTable::SampleArrivalDelay(const G4ThreeVector& position,
+                                                    const G4ThreeVector& direction) const
+{
+  if (!fTimeCDF) return 0.;
+  const float* cdf = fTimeCDF + FindDirectionCell(position, direction)*fBinning.nTime;
+
+  // Invert the binned CDF, spreading the delay uniformly inside the bin.
+  const float u = float(G4UniformRand()) * cdf[fBinning.nTime - 1];
+  const G4int bin = G4int(std::upper_bound(cdf, cdf + fBinning.nTime, u) - cdf);
+  const G4int clamped = std::min(bin, fBinning.nTime - 1);
+  const G4double binWidth = fBinning.timeMax / fBinning.nTime;
+  const G4double low  = clamped > 0 ? cdf[clamped - 1] : 0.;
+  const G4double high = cdf[clamped];
+  const G4double fraction = high > low ? (u - low) / (high - low) : 0.5;
+  return (clamped + fraction) * binWidth;
+}
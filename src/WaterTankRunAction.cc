@@ -2,6 +2,7 @@
 /// \brief Implementation of the WaterTankRunAction class
 
 #include "WaterTankRunAction.hh"
+#include "WaterTankRunMessenger.hh"
 #include "WaterTankPrimaryGeneratorAction.hh"
 #include "WaterTankDetectorConstruction.hh"
 #include "WaterTankAnalysis.hh"
@@ -18,16 +19,75 @@
 #include "globals.hh"
 #include "G4Run.hh"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+  // Events between two looks at the output file size for the size-based
+  // rollover; each look drains the asynchronous output first.
+  const G4int kSizeCheckEvents = 100;
+}
+
 WaterTankRunAction::WaterTankRunAction()
 : G4UserRunAction(),
+  fMessenger(nullptr),
+  fNtuplesBooked(false),
+  fNtupleMerging(true),
+  fAsyncOutputEvents(0),
+  fOutputLevel(kFullOutput),
+  fVectorHitLayout(true),
+  fTimeQuantiles({0.1, 0.9}),
+  fRunNumbering(false),
+  fRolloverEvents(0),
+  fRolloverMegabytes(0.),
+  fBaseFileName("output_default"),
+  fRunID(0),
+  fChunk(0),
+  fChunkEvents(0),
+  fChunkFirstEvent(-1),
+  fChunkLastEvent(-1),
+  fRolloverDue(false),
   fEdep(0.),
-  fEdep2(0.)
+  fEdep2(0.),
+  fCullCandidates(0),
+  fCulledPhotons(0),
+  fCullWeightKilled(0.),
+  fCullWeightAdded(0.),
+  fRouletteTrials(0),
+  fRouletteKilled(0),
+  fRouletteWeightKilled(0.),
+  fRouletteWeightAdded(0.),
+  fOutputEvents(0),
+  fOutputDepthSum(0.),
+  fOutputMaxDepth(0, G4MergeMode::kMaximum),
+  fOutputStalls(0),
+  fOutputStallSeconds(0.)
 { 
   // Register accumulable to the accumulable manager so that thread-local
   // contributions automatically merge at the end of the run.
   G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
   accumulableManager->Register(fEdep);
   accumulableManager->Register(fEdep2);
+  accumulableManager->Register(fCullCandidates);
+  accumulableManager->Register(fCulledPhotons);
+  accumulableManager->Register(fCullWeightKilled);
+  accumulableManager->Register(fCullWeightAdded);
+  accumulableManager->Register(fRouletteTrials);
+  accumulableManager->Register(fRouletteKilled);
+  accumulableManager->Register(fRouletteWeightKilled);
+  accumulableManager->Register(fRouletteWeightAdded);
+  accumulableManager->Register(fOutputEvents);
+  accumulableManager->Register(fOutputDepthSum);
+  accumulableManager->Register(fOutputMaxDepth);
+  accumulableManager->Register(fOutputStalls);
+  accumulableManager->Register(fOutputStallSeconds);
+
+  fMessenger = new WaterTankRunMessenger(this);
 
   // Hook up the Geant4 analysis manager. The header WaterTankAnalysis.hh can be
   // used to swap out the backend if we ever want CSV or XML instead of ROOT.
@@ -36,73 +96,274 @@ WaterTankRunAction::WaterTankRunAction()
 
   // Create directories 
   analysisManager->SetVerboseLevel(1);
-  if ( G4Threading::IsMultithreadedApplication() ) analysisManager->SetNtupleMerging(true);
+  // Ntuple merging is selected when the ntuples are booked; see BookNtuples.
+  // Ntuples above the selected output level are deactivated, which keeps
+  // them out of the file; see BeginOfRunAction.
+  analysisManager->SetActivation(true);
+}
+
+WaterTankRunAction::~WaterTankRunAction()
+{
+  delete fMessenger;
+  //delete G4AnalysisManager::Instance();  
+}
+
+void WaterTankRunAction::SetTimeQuantiles(const std::vector<G4double>& fractions)
+{
+  if (fNtuplesBooked) {
+    G4Exception("WaterTankRunAction::SetTimeQuantiles()", "RunOutput002", JustWarning,
+                "The ntuples are already booked; time quantiles can only be changed before the first run.");
+    return;
+  }
+  fTimeQuantiles = fractions;
+}
+
+void WaterTankRunAction::SetNtupleMerging(G4bool merge)
+{
+  if (fNtuplesBooked) {
+    G4Exception("WaterTankRunAction::SetNtupleMerging()", "RunOutput002", JustWarning,
+                "The ntuples are already booked; ntuple merging can only be changed before the first run.");
+    return;
+  }
+  fNtupleMerging = merge;
+}
+
+void WaterTankRunAction::SetOutputFormat(WaterTankNtupleOutput::Format format)
+{
+  if (fNtuplesBooked) {
+    G4Exception("WaterTankRunAction::SetOutputFormat()", "RunOutput002", JustWarning,
+                "The ntuples are already booked; the output format can only be changed before the first run.");
+    return;
+  }
+  fNtupleOutput.SetFormat(format);
+}
+
+void WaterTankRunAction::SetAsyncOutput(G4int events)
+{
+  if (fNtuplesBooked) {
+    G4Exception("WaterTankRunAction::SetAsyncOutput()", "RunOutput002", JustWarning,
+                "The ntuples are already booked; asynchronous output can only be changed before the first run.");
+    return;
+  }
+  fAsyncOutputEvents = events;
+}
+
+void WaterTankRunAction::SetVectorHitLayout(G4bool vectorLayout)
+{
+  if (fNtuplesBooked) {
+    G4Exception("WaterTankRunAction::SetVectorHitLayout()", "RunOutput002", JustWarning,
+                "The ntuples are already booked; the hit layout can only be changed before the first run.");
+    return;
+  }
+  fVectorHitLayout = vectorLayout;
+}
+
+void WaterTankRunAction::SetHitPrecision(const HitPrecision& precision)
+{
+  if (fNtuplesBooked) {
+    G4Exception("WaterTankRunAction::SetHitPrecision()", "RunOutput002", JustWarning,
+                "The ntuples are already booked; column precision can only be changed before the first run.");
+    return;
+  }
+  fHitPrecision = precision;
+}
+
+void WaterTankRunAction::BookNtuples()
+{
+  auto analysisManager = G4AnalysisManager::Instance();
+
+  // Merged ntuples funnel every worker row through the master at the end of
+  // the run. Without merging each worker writes its own file as it goes and
+  // the files are combined offline (hadd) or read as a TChain. Columnar
+  // files are always written by the workers, so the ROOT ones follow.
+  if (fNtupleMerging && fNtupleOutput.WritesColumnar() && G4Threading::IsMultithreadedApplication()) {
+    if (IsMaster()) {
+      G4Exception("WaterTankRunAction::BookNtuples()", "RunOutput005", JustWarning,
+                  "Columnar output is written per thread; ntuple merging is turned off.");
+    }
+    fNtupleMerging = false;
+  }
+  if ( G4Threading::IsMultithreadedApplication() ) analysisManager->SetNtupleMerging(fNtupleMerging);
+
+  // Rows are filled by the worker threads (or the only thread), so that is
+  // where a writer thread can take them over. The vector columns are bound
+  // while booking, so the queue is sized first and started at the end.
+  const G4bool fillsRows = !G4Threading::IsMultithreadedApplication() || !IsMaster();
+  fNtupleOutput.SetQueueCapacity(fillsRows ? fAsyncOutputEvents : 0);
 
   // Event-level summary ntuple: one row per event capturing how much energy
   // was deposited in the water and how many DOM hits were recorded.
-  analysisManager->CreateNtuple("event", "Event summary");
-  analysisManager->CreateNtupleIColumn("EventID");
-  analysisManager->CreateNtupleDColumn("Edep_GeV");
-  analysisManager->CreateNtupleIColumn("DOMHitCount");
+  fNtupleOutput.CreateNtuple("event", "Event summary");
+  fNtupleOutput.CreateNtupleIColumn("EventID");
+  fNtupleOutput.CreateNtupleDColumn("Edep_GeV");
+  // Weighted number of DOM hits (equals the hit count without bundling)
+  fNtupleOutput.CreateNtupleDColumn("DOMHitCount");
   // Primary particle information
-  analysisManager->CreateNtupleIColumn("PrimaryPDG");
-  analysisManager->CreateNtupleDColumn("PrimaryEnergy_GeV");
-  analysisManager->CreateNtupleDColumn("PrimaryX_cm");
-  analysisManager->CreateNtupleDColumn("PrimaryY_cm");
-  analysisManager->CreateNtupleDColumn("PrimaryZ_cm");
-  analysisManager->CreateNtupleDColumn("PrimaryDirX");
-  analysisManager->CreateNtupleDColumn("PrimaryDirY");
-  analysisManager->CreateNtupleDColumn("PrimaryDirZ");
+  fNtupleOutput.CreateNtupleIColumn("PrimaryPDG");
+  fNtupleOutput.CreateNtupleDColumn("PrimaryEnergy_GeV");
+  fNtupleOutput.CreateNtupleDColumn("PrimaryX_cm");
+  fNtupleOutput.CreateNtupleDColumn("PrimaryY_cm");
+  fNtupleOutput.CreateNtupleDColumn("PrimaryZ_cm");
+  fNtupleOutput.CreateNtupleDColumn("PrimaryDirX");
+  fNtupleOutput.CreateNtupleDColumn("PrimaryDirY");
+  fNtupleOutput.CreateNtupleDColumn("PrimaryDirZ");
   // Physics analysis variables
-  analysisManager->CreateNtupleDColumn("PhotonYield_per_GeV");
-  analysisManager->CreateNtupleDColumn("FirstPhotonTime_ns");
-  analysisManager->CreateNtupleDColumn("LastPhotonTime_ns");
-  analysisManager->CreateNtupleDColumn("AvgPhotonWavelength_nm");
+  fNtupleOutput.CreateNtupleDColumn("PhotonYield_per_GeV");
+  fNtupleOutput.CreateNtupleDColumn("FirstPhotonTime_ns");
+  fNtupleOutput.CreateNtupleDColumn("LastPhotonTime_ns");
+  fNtupleOutput.CreateNtupleDColumn("AvgPhotonWavelength_nm");
   // Extended timing statistics for physics validation
-  analysisManager->CreateNtupleDColumn("TimeRMS_ns");
-  analysisManager->CreateNtupleDColumn("TimeMedian_ns");
-  analysisManager->FinishNtuple();
-
-  // Detailed DOM hit ntuple: one row per detected photon with position,
-  // direction, and provenance. This provides the raw material for timing and
-  // angular studies when reviewing the simulation output in ROOT.
-  analysisManager->CreateNtuple("domhits", "DOM photon hits");
-  analysisManager->CreateNtupleIColumn("EventID");
-  analysisManager->CreateNtupleIColumn("TrackID");
-  analysisManager->CreateNtupleIColumn("ParentID");
-  analysisManager->CreateNtupleDColumn("Time_ns");
-  analysisManager->CreateNtupleDColumn("Energy_eV");
-  analysisManager->CreateNtupleDColumn("Wavelength_nm");
-  analysisManager->CreateNtupleDColumn("PosX_cm");
-  analysisManager->CreateNtupleDColumn("PosY_cm");
-  analysisManager->CreateNtupleDColumn("PosZ_cm");
-  analysisManager->CreateNtupleDColumn("DirX");
-  analysisManager->CreateNtupleDColumn("DirY");
-  analysisManager->CreateNtupleDColumn("DirZ");
-  analysisManager->FinishNtuple();
+  fNtupleOutput.CreateNtupleDColumn("TimeRMS_ns");
+  fNtupleOutput.CreateNtupleDColumn("TimeMedian_ns");
+  // Variance of DOMHitCount, the sum of squared hit weights
+  fNtupleOutput.CreateNtupleDColumn("DOMHitCountVar");
+  // Optical photons killed after the readout window closed
+  fNtupleOutput.CreateNtupleIColumn("KilledLatePhotons");
+  // Configurable hit-time quantiles, e.g. T10_ns and T90_ns
+  for (G4double fraction : fTimeQuantiles) {
+    std::ostringstream name;
+    name << "T" << 100. * fraction << "_ns";
+    G4String columnName = name.str();
+    std::replace(columnName.begin(), columnName.end(), '.', 'p');
+    fNtupleOutput.CreateNtupleDColumn(columnName);
+  }
+  fNtupleOutput.FinishNtuple();
 
-}
+  // Detailed DOM hit ntuple with position, direction, and provenance of every
+  // detected photon. This provides the raw material for timing and angular
+  // studies when reviewing the simulation output in ROOT. In vector layout an
+  // event is one row of per-photon vectors, which avoids the per-row overhead
+  // and the repeated EventID of one row per photon; TTree::Draw expressions
+  // work the same on both layouts.
+  if (fVectorHitLayout) {
+    // Quantized groups become integer columns named *_ticks; the steps are
+    // recorded in the ntuple title so the file documents itself, and in
+    // per-event columns so that decoding expressions can use them.
+    std::ostringstream title;
+    title << "DOM photon hits, one row per event";
+    if (fHitPrecision.timeStep > 0.) {
+      title << "; Time_ticks x " << fHitPrecision.timeStep << " ns after TimeReference_ns";
+    }
+    if (fHitPrecision.energyStep > 0.) title << "; Energy_ticks x " << fHitPrecision.energyStep << " eV";
+    if (fHitPrecision.positionStep > 0.) title << "; Pos*_ticks x " << fHitPrecision.positionStep << " cm";
+    if (fHitPrecision.octahedralDirections) title << "; DirOct octahedral int16 pair";
 
-WaterTankRunAction::~WaterTankRunAction()
-{
-  //delete G4AnalysisManager::Instance();  
+    fNtupleOutput.CreateNtuple("domhits", title.str());
+    fNtupleOutput.CreateNtupleIColumn("EventID");
+    fNtupleOutput.CreateNtupleIColumn("NHits");
+    // Hit times are stored relative to the event's first hit.
+    fNtupleOutput.CreateNtupleDColumn("TimeReference_ns");
+    if (fHitPrecision.timeStep > 0.) fNtupleOutput.CreateNtupleDColumn("TimeStep_ns");
+    if (fHitPrecision.energyStep > 0.) fNtupleOutput.CreateNtupleDColumn("EnergyStep_eV");
+    if (fHitPrecision.positionStep > 0.) fNtupleOutput.CreateNtupleDColumn("PositionStep_cm");
+    fNtupleOutput.CreateNtupleIColumn("TrackID", fHitColumns.trackID);
+    fNtupleOutput.CreateNtupleIColumn("ParentID", fHitColumns.parentID);
+    if (fHitPrecision.timeStep > 0.) {
+      fNtupleOutput.CreateNtupleIColumn("Time_ticks", fHitColumns.timeTicks);
+    } else {
+      fNtupleOutput.CreateNtupleFColumn("TimeOffset_ns", fHitColumns.time);
+    }
+    // The wavelength follows from the energy, so a quantized energy drops it.
+    if (fHitPrecision.energyStep > 0.) {
+      fNtupleOutput.CreateNtupleIColumn("Energy_ticks", fHitColumns.energyTicks);
+    } else {
+      fNtupleOutput.CreateNtupleFColumn("Energy_eV", fHitColumns.energy);
+      fNtupleOutput.CreateNtupleFColumn("Wavelength_nm", fHitColumns.wavelength);
+    }
+    if (fHitPrecision.positionStep > 0.) {
+      fNtupleOutput.CreateNtupleIColumn("PosX_ticks", fHitColumns.posXTicks);
+      fNtupleOutput.CreateNtupleIColumn("PosY_ticks", fHitColumns.posYTicks);
+      fNtupleOutput.CreateNtupleIColumn("PosZ_ticks", fHitColumns.posZTicks);
+    } else {
+      fNtupleOutput.CreateNtupleFColumn("PosX_cm", fHitColumns.posX);
+      fNtupleOutput.CreateNtupleFColumn("PosY_cm", fHitColumns.posY);
+      fNtupleOutput.CreateNtupleFColumn("PosZ_cm", fHitColumns.posZ);
+    }
+    if (fHitPrecision.octahedralDirections) {
+      fNtupleOutput.CreateNtupleIColumn("DirOct", fHitColumns.dirOctahedral);
+    } else {
+      fNtupleOutput.CreateNtupleFColumn("DirX", fHitColumns.dirX);
+      fNtupleOutput.CreateNtupleFColumn("DirY", fHitColumns.dirY);
+      fNtupleOutput.CreateNtupleFColumn("DirZ", fHitColumns.dirZ);
+    }
+    fNtupleOutput.CreateNtupleFColumn("Weight", fHitColumns.weight);
+    fNtupleOutput.FinishNtuple();
+  }
+  else {
+    fNtupleOutput.CreateNtuple("domhits", "DOM photon hits");
+    fNtupleOutput.CreateNtupleIColumn("EventID");
+    fNtupleOutput.CreateNtupleIColumn("TrackID");
+    fNtupleOutput.CreateNtupleIColumn("ParentID");
+    fNtupleOutput.CreateNtupleDColumn("Time_ns");
+    fNtupleOutput.CreateNtupleDColumn("Energy_eV");
+    fNtupleOutput.CreateNtupleDColumn("Wavelength_nm");
+    fNtupleOutput.CreateNtupleDColumn("PosX_cm");
+    fNtupleOutput.CreateNtupleDColumn("PosY_cm");
+    fNtupleOutput.CreateNtupleDColumn("PosZ_cm");
+    fNtupleOutput.CreateNtupleDColumn("DirX");
+    fNtupleOutput.CreateNtupleDColumn("DirY");
+    fNtupleOutput.CreateNtupleDColumn("DirZ");
+    fNtupleOutput.CreateNtupleDColumn("Weight");
+    fNtupleOutput.FinishNtuple();
+  }
+
+  // Digitized DOM readout: one row per DOM with charge in the event, giving
+  // the integrated charge and the leading-edge and charge-weighted times,
+  // the sampled waveform and the pulses extracted from it.
+  fNtupleOutput.CreateNtuple("domdigi", "Digitized DOM readout; Waveform in PE per sample");
+  fNtupleOutput.CreateNtupleIColumn("EventID");
+  fNtupleOutput.CreateNtupleIColumn("DOMID");
+  fNtupleOutput.CreateNtupleDColumn("Charge_pe");
+  fNtupleOutput.CreateNtupleDColumn("LeadingTime_ns");
+  fNtupleOutput.CreateNtupleDColumn("MeanTime_ns");
+  fNtupleOutput.CreateNtupleIColumn("NPulses");
+  fNtupleOutput.CreateNtupleDColumn("WindowStart_ns");
+  fNtupleOutput.CreateNtupleDColumn("SamplingPeriod_ns");
+  fNtupleOutput.CreateNtupleFColumn("Waveform", fDigiColumns.waveform);
+  fNtupleOutput.CreateNtupleFColumn("PulseOffset_ns", fDigiColumns.pulseTime);
+  fNtupleOutput.CreateNtupleFColumn("PulseCharge_pe", fDigiColumns.pulseCharge);
+  fNtupleOutput.FinishNtuple();
+
+  fNtupleOutput.StartQueue();
+  fNtuplesBooked = true;
 }
 
-void WaterTankRunAction::BeginOfRunAction(const G4Run*)
+void WaterTankRunAction::BeginOfRunAction(const G4Run* run)
 { 
   // inform the runManager to save random number seed
   G4RunManager::GetRunManager()->SetRandomNumberStore(false);
   
   // Get analysis manager
   auto analysisManager = G4AnalysisManager::Instance();
+  if (!fNtuplesBooked) BookNtuples();
+  // The event summary is always written; the per-photon and digitized
+  // ntuples only at the levels that include them.
+  fNtupleOutput.SetNtupleActivation(1, fOutputLevel >= kFullOutput);
+  fNtupleOutput.SetNtupleActivation(2, fOutputLevel >= kDigitizedOutput);
   
   // Access detector construction for geometry info if needed.
   // (Previously printed radiation length which was calorimetry-specific.)
 
-  // Write output to a deterministic filename unless changed via macro. ROOT
-  // will append a thread suffix automatically when ntuple merging is disabled.
-  G4String fileName = "output_default.root";
-  analysisManager->OpenFile(fileName);
+  // Write output to a deterministic filename unless changed via macro
+  // (/analysis/setFileName), with the run and chunk suffixes when enabled.
+  // Geant4 appends a thread suffix to the worker files when ntuple merging
+  // is disabled.
+  G4String fileName = analysisManager->GetFileName();
+  if (!fileName.empty() && fileName != fOpenedFileName) {
+    const std::size_t extension = fileName.rfind(".root");
+    fBaseFileName = (extension != std::string::npos && extension + 5 == fileName.size())
+                    ? G4String(fileName.substr(0, extension)) : fileName;
+  }
+  if (IsMaster() && G4Threading::IsMultithreadedApplication() && fNtupleMerging
+      && (fRolloverEvents > 0 || fRolloverMegabytes > 0.)) {
+    G4Exception("WaterTankRunAction::BeginOfRunAction()", "RunOutput003", JustWarning,
+                "Output rollover needs /watertank/output/merge false in multi-threaded runs; "
+                "writing one file per run.");
+  }
+  fRunID = run->GetRunID();
+  fChunk = 0;
+  OpenChunk();
+  if (auto queue = fNtupleOutput.GetQueue()) queue->ResetStatistics();
 
 
 
@@ -115,6 +376,16 @@ void WaterTankRunAction::EndOfRunAction(const G4Run* run)
 {
   G4int nofEvents = run->GetNumberOfEvent();
   if (nofEvents == 0) return;
+
+  // The output queue counters are plain members of this thread's queue;
+  // hand them to the accumulables before merging.
+  if (auto queue = fNtupleOutput.GetQueue()) {
+    fOutputEvents += queue->GetSubmitted();
+    fOutputDepthSum += queue->GetDepthSum();
+    fOutputMaxDepth += queue->GetMaxDepth();
+    fOutputStalls += queue->GetStalls();
+    fOutputStallSeconds += queue->GetStallSeconds();
+  }
   
   // Merge accumulables 
   G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
@@ -171,15 +442,174 @@ void WaterTankRunAction::EndOfRunAction(const G4Run* run)
      << G4endl
      << " Average energy deposition per particle : " 
      << G4BestUnit(edep,"Energy") << " +/- " << G4BestUnit(rms,"Energy")
+     << G4endl;
+
+  // Photon culling is opt-in; only report it when the stacking action saw
+  // candidates so the summary stays unchanged for regular runs.
+  if (fCullCandidates.GetValue() > 0) {
+    G4long candidates = fCullCandidates.GetValue();
+    G4long culled = fCulledPhotons.GetValue();
+    G4cout
+     << " Optical photons culled at birth : " << culled << " of " << candidates
+     << " (" << 100. * culled / candidates << " %)"
+     << G4endl
+     << " Culling weight killed / given to survivors : "
+     << fCullWeightKilled.GetValue() << " / " << fCullWeightAdded.GetValue()
+     << G4endl;
+  }
+
+  // Same for Russian roulette: the killed and added weights should agree
+  // within statistics, otherwise the roulette is biasing the hit counts.
+  if (fRouletteTrials.GetValue() > 0) {
+    G4long trials = fRouletteTrials.GetValue();
+    G4long killed = fRouletteKilled.GetValue();
+    G4cout
+     << " Optical photon Russian roulettes : " << trials
+     << ", killed " << killed << " (" << 100. * killed / trials << " %)"
      << G4endl
+     << " Roulette weight killed / given to survivors : "
+     << fRouletteWeightKilled.GetValue() << " / " << fRouletteWeightAdded.GetValue()
+     << G4endl;
+  }
+
+  // Asynchronous output: a mean depth near the capacity or many stalls
+  // mean the writer threads cannot keep up with the event loop.
+  if (fOutputEvents.GetValue() > 0) {
+    G4long events = fOutputEvents.GetValue();
+    G4cout
+     << " Output queue : " << events << " events, mean depth "
+     << fOutputDepthSum.GetValue() / events << ", max depth " << fOutputMaxDepth.GetValue()
+     << " of " << fAsyncOutputEvents
+     << G4endl
+     << " Event loop waits on a full output queue : " << fOutputStalls.GetValue()
+     << " (" << G4BestUnit(fOutputStallSeconds.GetValue() * s, "Time") << ")"
+     << G4endl;
+  }
+
+  G4cout
      << "------------------------------------------------------------"
      << G4endl
      << G4endl;
-  // Persist histograms and ntuples. The analysis manager owns the file handle,
-  // so CloseFile() also triggers writing any buffered data to disk.
-  auto analysisManager = G4AnalysisManager::Instance();
-  analysisManager->Write();
-  analysisManager->CloseFile();
+  // Persist histograms and ntuples. The master of a merged run writes the
+  // rows of every event, numbered from 0.
+  if (IsMaster() && G4Threading::IsMultithreadedApplication() && fNtupleMerging) {
+    fChunkEvents = nofEvents;
+    fChunkFirstEvent = 0;
+    fChunkLastEvent = nofEvents - 1;
+  }
+  CloseChunk();
+}
+
+G4bool WaterTankRunAction::WritesRowsDirectly() const
+{
+  return !G4Threading::IsMultithreadedApplication() || (!IsMaster() && !fNtupleMerging);
+}
+
+G4bool WaterTankRunAction::RollsOver() const
+{
+  return WritesRowsDirectly() && (fRolloverEvents > 0 || fRolloverMegabytes > 0.);
+}
+
+void WaterTankRunAction::OpenChunk()
+{
+  std::ostringstream name;
+  name << fBaseFileName;
+  if (fRunNumbering) name << "_run" << fRunID;
+  if (RollsOver()) name << "_c" << fChunk;
+  fOpenedFileName = name.str() + ".root";
+  if (G4Threading::IsMultithreadedApplication() && !IsMaster() && !fNtupleMerging) {
+    name << "_t" << G4Threading::G4GetThreadId();
+  }
+  // The master of a multi-threaded run has no rows for a columnar file.
+  fWrittenColumnarName.clear();
+  if (fNtupleOutput.WritesColumnar() && WritesRowsDirectly()) fWrittenColumnarName = name.str() + ".wtc";
+  fWrittenFileName = fNtupleOutput.WritesRoot() ? G4String(name.str() + ".root") : fWrittenColumnarName;
+
+  fChunkEvents = 0;
+  fChunkFirstEvent = fChunkLastEvent = -1;
+  fRolloverDue = false;
+  fNtupleOutput.OpenFile(fOpenedFileName, fWrittenColumnarName);
+}
+
+void WaterTankRunAction::CloseChunk()
+{
+  // The analysis manager and the columnar writer own the file handles, so
+  // CloseFile() also triggers writing any buffered data to disk.
+  fNtupleOutput.CloseFile();
+
+  // Only the thread whose file holds the rows describes it.
+  if (WritesRowsDirectly() || (IsMaster() && fNtupleMerging)) WriteManifest();
+}
+
+void WaterTankRunAction::BeginEventOutput()
+{
+  if (!fRolloverDue) return;
+  CloseChunk();
+  ++fChunk;
+  OpenChunk();
+}
+
+void WaterTankRunAction::EndEventOutput(G4int eventID)
+{
+  if (!WritesRowsDirectly()) return;
+  if (fChunkEvents == 0) fChunkFirstEvent = eventID;
+  fChunkLastEvent = eventID;
+  ++fChunkEvents;
+  if (!RollsOver()) return;
+
+  // The switch waits for the next event so that a run never ends on an
+  // empty chunk. The size is only read every few events, once the queued
+  // rows reached the backends. ROOT and the columnar writer write baskets
+  // and chunks as they fill, so the size on disk still trails the rows by
+  // at most a basket per branch or a chunk per table.
+  G4bool full = fRolloverEvents > 0 && fChunkEvents >= fRolloverEvents;
+  if (!full && fRolloverMegabytes > 0. && fChunkEvents % kSizeCheckEvents == 0) {
+    fNtupleOutput.Drain();
+    std::error_code error;
+    const auto bytes = std::filesystem::file_size(fWrittenFileName, error);
+    full = !error && bytes >= fRolloverMegabytes * 1.e6;
+  }
+  fRolloverDue = full;
+}
+
+void WaterTankRunAction::WriteManifest() const
+{
+  std::error_code error;
+  const auto bytes = std::filesystem::file_size(fWrittenFileName, error);
+  const char* levels[] = {"summary", "digitized", "full"};
+
+  // Written under a temporary name and renamed, so that a manifest that
+  // exists is complete and its output file closed.
+  const std::string manifestName = fWrittenFileName + ".manifest";
+  const std::string temporaryName = manifestName + ".tmp";
+  {
+    std::ofstream out(temporaryName);
+    out << "{\n"
+        << "  \"file\": \"" << fWrittenFileName << "\",\n";
+    if (fNtupleOutput.WritesRoot() && !fWrittenColumnarName.empty()) {
+      out << "  \"columnarFile\": \"" << fWrittenColumnarName << "\",\n";
+    }
+    out << "  \"run\": " << fRunID << ",\n"
+        << "  \"thread\": " << (IsMaster() ? -1 : G4Threading::G4GetThreadId()) << ",\n"
+        << "  \"chunk\": " << fChunk << ",\n"
+        << "  \"events\": " << fChunkEvents << ",\n"
+        << "  \"firstEventID\": " << fChunkFirstEvent << ",\n"
+        << "  \"lastEventID\": " << fChunkLastEvent << ",\n"
+        << "  \"bytes\": " << (error ? -1 : G4long(bytes)) << ",\n"
+        << "  \"outputLevel\": \"" << levels[fOutputLevel] << "\"\n"
+        << "}\n";
+    if (!out) {
+      G4ExceptionDescription msg;
+      msg << "Cannot write the output manifest " << temporaryName << ".";
+      G4Exception("WaterTankRunAction::WriteManifest()", "RunOutput004", JustWarning, msg);
+      return;
+    }
+  }
+  if (std::rename(temporaryName.c_str(), manifestName.c_str()) != 0) {
+    G4ExceptionDescription msg;
+    msg << "Cannot rename the output manifest to " << manifestName << ".";
+    G4Exception("WaterTankRunAction::WriteManifest()", "RunOutput004", JustWarning, msg);
+  }
 }
 
 void WaterTankRunAction::AddEdep(G4double edep)
@@ -0,0 +1,224 @@
+/// \file WaterTankRunMessenger.cc
+/// \brief Implementation of the WaterTankRunMessenger class
+
+#include "WaterTankRunMessenger.hh"
+#include "WaterTankRunAction.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+
+#include <sstream>
+#include <vector>
+
+WaterTankRunMessenger::WaterTankRunMessenger(WaterTankRunAction* runAction)
+: G4UImessenger(),
+  fRunAction(runAction)
+{
+  // Create directory for output commands
+  fOutputDirectory = new G4UIdirectory("/watertank/output/");
+  fOutputDirectory->SetGuidance("Content of the ROOT output");
+
+  // Command to choose the hit-time quantile columns of the event ntuple
+  fTimeQuantilesCmd = new G4UIcmdWithAString("/watertank/output/timeQuantiles", this);
+  fTimeQuantilesCmd->SetGuidance("Hit-time quantiles stored as extra event columns");
+  fTimeQuantilesCmd->SetGuidance("  Space-separated fractions in (0, 1); each adds a column named");
+  fTimeQuantilesCmd->SetGuidance("  after its percentage, e.g. 0.1 0.9 gives T10_ns and T90_ns.");
+  fTimeQuantilesCmd->SetGuidance("  \"none\" stores no quantile columns. Takes effect at the first run.");
+  fTimeQuantilesCmd->SetParameterName("fractions", false);
+  fTimeQuantilesCmd->SetDefaultValue("0.1 0.9");
+  fTimeQuantilesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to select the output level
+  fLevelCmd = new G4UIcmdWithAString("/watertank/output/level", this);
+  fLevelCmd->SetGuidance("Select how much is written per event (from the next run on)");
+  fLevelCmd->SetGuidance("  summary:   the event ntuple only");
+  fLevelCmd->SetGuidance("  digitized: plus the domdigi ntuple (charge and times per DOM)");
+  fLevelCmd->SetGuidance("  full:      plus the domhits ntuple, one row per photon (default)");
+  fLevelCmd->SetParameterName("level", false);
+  fLevelCmd->SetCandidates("summary digitized full");
+  fLevelCmd->SetDefaultValue("full");
+  fLevelCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to restore the one-row-per-photon domhits layout
+  fHitRowsCmd = new G4UIcmdWithABool("/watertank/output/hitRows", this);
+  fHitRowsCmd->SetGuidance("Write domhits as one row per photon instead of one row per event");
+  fHitRowsCmd->SetGuidance("  By default each event is one row of per-photon vector columns.");
+  fHitRowsCmd->SetGuidance("  Takes effect at the first run.");
+  fHitRowsCmd->SetParameterName("rows", true);
+  fHitRowsCmd->SetDefaultValue(true);
+  fHitRowsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to write one output file per worker thread
+  fMergeCmd = new G4UIcmdWithABool("/watertank/output/merge", this);
+  fMergeCmd->SetGuidance("Merge the worker ntuples into one file through the master (default)");
+  fMergeCmd->SetGuidance("  If false, each worker thread writes its own <name>_t<N>.root file;");
+  fMergeCmd->SetGuidance("  combine them with hadd -j or read them as a TChain.");
+  fMergeCmd->SetGuidance("  Takes effect at the first run.");
+  fMergeCmd->SetParameterName("merge", true);
+  fMergeCmd->SetDefaultValue(true);
+  fMergeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to select the ntuple backend
+  fFormatCmd = new G4UIcmdWithAString("/watertank/output/format", this);
+  fFormatCmd->SetGuidance("File format of the ntuples");
+  fFormatCmd->SetGuidance("  root:     ROOT files through the Geant4 analysis manager (default)");
+  fFormatCmd->SetGuidance("  columnar: per-thread .wtc files (convert with convert_columnar.C)");
+  fFormatCmd->SetGuidance("  both:     both, with the same schema");
+  fFormatCmd->SetGuidance("  Columnar output turns ntuple merging off. Takes effect at the first run.");
+  fFormatCmd->SetParameterName("format", false);
+  fFormatCmd->SetCandidates("root columnar both");
+  fFormatCmd->SetDefaultValue("root");
+  fFormatCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to write the ntuples on a separate thread
+  fAsyncCmd = new G4UIcmdWithAnInteger("/watertank/output/asyncQueue", this);
+  fAsyncCmd->SetGuidance("Write the columnar ntuple rows on a writer thread per event-loop thread");
+  fAsyncCmd->SetGuidance("  ROOT rows are always filled by the event-loop thread.");
+  fAsyncCmd->SetGuidance("  The parameter is the number of events the writer may fall behind");
+  fAsyncCmd->SetGuidance("  before the event loop waits; 0 writes synchronously (default).");
+  fAsyncCmd->SetGuidance("  Takes effect at the first run.");
+  fAsyncCmd->SetParameterName("events", false);
+  fAsyncCmd->SetRange("events >= 0");
+  fAsyncCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to number the output files by run
+  fRunNumberingCmd = new G4UIcmdWithABool("/watertank/output/runNumbering", this);
+  fRunNumberingCmd->SetGuidance("Append the run number to the output file name (<name>_run<N>.root)");
+  fRunNumberingCmd->SetGuidance("  so that successive /run/beamOn do not overwrite each other.");
+  fRunNumberingCmd->SetParameterName("numbering", true);
+  fRunNumberingCmd->SetDefaultValue(true);
+  fRunNumberingCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Commands to roll the output over to a new file during a run
+  fRolloverEventsCmd = new G4UIcmdWithAnInteger("/watertank/output/rolloverEvents", this);
+  fRolloverEventsCmd->SetGuidance("Start a new output file (<name>_c<K>.root) every N events (0: never)");
+  fRolloverEventsCmd->SetGuidance("  Counted per file, i.e. per worker thread when merging is off.");
+  fRolloverEventsCmd->SetGuidance("  Needs /watertank/output/merge false in multi-threaded runs.");
+  fRolloverEventsCmd->SetParameterName("events", false);
+  fRolloverEventsCmd->SetRange("events >= 0");
+  fRolloverEventsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fRolloverSizeCmd = new G4UIcmdWithADouble("/watertank/output/rolloverSize", this);
+  fRolloverSizeCmd->SetGuidance("Start a new output file once the open one reaches this size in MB (0: never)");
+  fRolloverSizeCmd->SetGuidance("  The size is checked every 100 events.");
+  fRolloverSizeCmd->SetGuidance("  Needs /watertank/output/merge false in multi-threaded runs.");
+  fRolloverSizeCmd->SetParameterName("megabytes", false);
+  fRolloverSizeCmd->SetRange("megabytes >= 0.");
+  fRolloverSizeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to quantize a group of domhits columns
+  fPrecisionCmd = new G4UIcommand("/watertank/output/precision", this);
+  fPrecisionCmd->SetGuidance("Store a group of domhits vector columns as fixed-point integers");
+  fPrecisionCmd->SetGuidance("  time:     Time_ticks, step in ns (e.g. 0.1)");
+  fPrecisionCmd->SetGuidance("  energy:   Energy_ticks, step in eV (Wavelength_nm is then dropped)");
+  fPrecisionCmd->SetGuidance("  position: PosX/Y/Z_ticks, step in cm");
+  fPrecisionCmd->SetGuidance("  A step of 0 keeps the float column. Takes effect at the first run.");
+  auto groupParameter = new G4UIparameter("group", 's', false);
+  groupParameter->SetParameterCandidates("time energy position");
+  fPrecisionCmd->SetParameter(groupParameter);
+  auto stepParameter = new G4UIparameter("step", 'd', false);
+  stepParameter->SetParameterRange("step >= 0.");
+  fPrecisionCmd->SetParameter(stepParameter);
+  fPrecisionCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to store directions in the octahedral encoding
+  fOctahedralCmd = new G4UIcmdWithABool("/watertank/output/octahedralDirections", this);
+  fOctahedralCmd->SetGuidance("Store hit directions as one packed int16 octahedral pair (DirOct)");
+  fOctahedralCmd->SetGuidance("  instead of DirX/Y/Z; see WaterTankOutputEncoding.hh for decoding.");
+  fOctahedralCmd->SetGuidance("  Takes effect at the first run.");
+  fOctahedralCmd->SetParameterName("octahedral", true);
+  fOctahedralCmd->SetDefaultValue(true);
+  fOctahedralCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+WaterTankRunMessenger::~WaterTankRunMessenger()
+{
+  delete fTimeQuantilesCmd;
+  delete fLevelCmd;
+  delete fHitRowsCmd;
+  delete fMergeCmd;
+  delete fFormatCmd;
+  delete fAsyncCmd;
+  delete fRunNumberingCmd;
+  delete fRolloverEventsCmd;
+  delete fRolloverSizeCmd;
+  delete fPrecisionCmd;
+  delete fOctahedralCmd;
+  delete fOutputDirectory;
+}
+
+void WaterTankRunMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if (command == fTimeQuantilesCmd) {
+    std::vector<G4double> fractions;
+    if (newValue != "none") {
+      std::istringstream input(newValue);
+      G4double fraction;
+      while (input >> fraction) {
+        if (fraction <= 0. || fraction >= 1.) {
+          G4ExceptionDescription msg;
+          msg << "Time quantile " << fraction << " is outside (0, 1); command ignored.";
+          G4Exception("WaterTankRunMessenger::SetNewValue()", "RunOutput001", JustWarning, msg);
+          return;
+        }
+        fractions.push_back(fraction);
+      }
+      if (!input.eof()) {
+        G4ExceptionDescription msg;
+        msg << "Cannot read time quantiles from \"" << newValue << "\"; command ignored.";
+        G4Exception("WaterTankRunMessenger::SetNewValue()", "RunOutput001", JustWarning, msg);
+        return;
+      }
+    }
+    fRunAction->SetTimeQuantiles(fractions);
+  }
+  else if (command == fLevelCmd) {
+    if (newValue == "summary") fRunAction->SetOutputLevel(WaterTankRunAction::kSummaryOutput);
+    else if (newValue == "digitized") fRunAction->SetOutputLevel(WaterTankRunAction::kDigitizedOutput);
+    else fRunAction->SetOutputLevel(WaterTankRunAction::kFullOutput);
+  }
+  else if (command == fHitRowsCmd) {
+    fRunAction->SetVectorHitLayout(!fHitRowsCmd->GetNewBoolValue(newValue));
+  }
+  else if (command == fMergeCmd) {
+    fRunAction->SetNtupleMerging(fMergeCmd->GetNewBoolValue(newValue));
+  }
+  else if (command == fFormatCmd) {
+    if (newValue == "columnar") fRunAction->SetOutputFormat(WaterTankNtupleOutput::kColumnarFormat);
+    else if (newValue == "both") fRunAction->SetOutputFormat(WaterTankNtupleOutput::kRootAndColumnarFormat);
+    else fRunAction->SetOutputFormat(WaterTankNtupleOutput::kRootFormat);
+  }
+  else if (command == fAsyncCmd) {
+    fRunAction->SetAsyncOutput(fAsyncCmd->GetNewIntValue(newValue));
+  }
+  else if (command == fRunNumberingCmd) {
+    fRunAction->SetRunNumbering(fRunNumberingCmd->GetNewBoolValue(newValue));
+  }
+  else if (command == fRolloverEventsCmd) {
+    fRunAction->SetRolloverEvents(fRolloverEventsCmd->GetNewIntValue(newValue));
+  }
+  else if (command == fRolloverSizeCmd) {
+    fRunAction->SetRolloverSize(fRolloverSizeCmd->GetNewDoubleValue(newValue));
+  }
+  else if (command == fPrecisionCmd) {
+    std::istringstream input(newValue);
+    G4String group;
+    G4double step = 0.;
+    input >> group >> step;
+    WaterTankRunAction::HitPrecision precision = fRunAction->GetHitPrecision();
+    if (group == "time") precision.timeStep = step;
+    else if (group == "energy") precision.energyStep = step;
+    else precision.positionStep = step;
+    fRunAction->SetHitPrecision(precision);
+  }
+  else if (command == fOctahedralCmd) {
+    WaterTankRunAction::HitPrecision precision = fRunAction->GetHitPrecision();
+    precision.octahedralDirections = fOctahedralCmd->GetNewBoolValue(newValue);
+    fRunAction->SetHitPrecision(precision);
+  }
+}
@@ -0,0 +1,249 @@
+/// \file WaterTankStackingAction.cc
+/// \brief Implementation of the WaterTankStackingAction class
+
+#include "WaterTankStackingAction.hh"
+#include "WaterTankStackingMessenger.hh"
+#include "WaterTankRunAction.hh"
+#include "WaterTankDetectorConstruction.hh"
+#include "WaterTankDOMSD.hh"
+
+#include "G4RunManager.hh"
+#include "G4Track.hh"
+#include "G4OpticalPhoton.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Material.hh"
+#include "G4MaterialPropertiesTable.hh"
+#include "G4ProcessTable.hh"
+#include "G4ProcessVector.hh"
+#include "G4Cerenkov.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+  // Lowest survival chance of a photon below the culling threshold, which
+  // caps the weight of survivors at 100 times their birth weight.
+  const G4double kMinCullSurvival = 0.01;
+}
+
+WaterTankStackingAction::WaterTankStackingAction(WaterTankRunAction* runAction)
+: G4UserStackingAction(),
+  fRunAction(runAction),
+  fMessenger(nullptr),
+  fCullPhotons(false),
+  fCullThreshold(1.e-2),
+  fQEFirst(false),
+  fAnalyticPropagation(false),
+  fTableLookup(false),
+  fBundleSize(1),
+  fTimeWindow(0.),
+  fRouletteInterval(0),
+  fRouletteSurvival(0.5),
+  fEmissionQE(1.),
+  fCerenkovStacking(true),
+  fDOMSD(nullptr)
+{
+  fMessenger = new WaterTankStackingMessenger(this);
+}
+
+WaterTankStackingAction::~WaterTankStackingAction()
+{
+  delete fMessenger;
+}
+
+void WaterTankStackingAction::PrepareNewEvent()
+{
+  // Geometry and materials are only guaranteed to exist once the run has been
+  // initialized, so pick them up before the first event on this thread.
+  if (!fGeometry.IsConfigured()) {
+    Configure();
+  }
+
+  // Table lookup makes the hits itself, so G4Cerenkov need not create any
+  // photons; this removes their cost at the source rather than in
+  // ClassifyNewTrack, which only kills strays.
+  const G4bool tableLookup = GetActiveResponseTable() != nullptr;
+  SetCerenkovStacking(!tableLookup);
+
+  // Keep the DOM's efficiency sampling consistent with the emission thinning
+  // chosen for this event. Without an SD there is nothing to compensate, so
+  // QE-first mode stays inactive. Table lookup bypasses QE-first: it applies
+  // the full efficiency to each emitted photon and tracks none.
+  fEmissionQE = 1.;
+  const G4bool qeFirst = fQEFirst && !tableLookup;
+  if (fDOMSD) {
+    fDOMSD->SetTimeWindow(fTimeWindow);
+    fDOMSD->SetQEFirst(qeFirst);
+    if (qeFirst) fEmissionQE = fDOMSD->GetMaxEfficiency();
+  }
+}
+
+void WaterTankStackingAction::SetCerenkovStacking(G4bool stack)
+{
+  if (stack == fCerenkovStacking) return;
+  // Processes are per thread, like the process table that finds them.
+  G4ProcessVector* processes = G4ProcessTable::GetProcessTable()->FindProcesses("Cerenkov");
+  for (G4int i = 0; i < G4int(processes->size()); ++i) {
+    if (auto cerenkov = dynamic_cast<G4Cerenkov*>((*processes)[i])) {
+      cerenkov->SetStackPhotons(stack);
+    }
+  }
+  delete processes;
+  fCerenkovStacking = stack;
+}
+
+void WaterTankStackingAction::Configure()
+{
+  fDOMSD = WaterTankDOMSD::Instance();
+
+  const WaterTankDetectorConstruction* detectorConstruction
+    = static_cast<const WaterTankDetectorConstruction*>
+      (G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+  if (!fGeometry.Configure(detectorConstruction)) {
+    return;
+  }
+
+  // Use the same optical tables Geant4 samples during tracking so that the
+  // survival estimate follows any change made in the detector construction.
+  const G4Material* water = detectorConstruction->GetWaterLogicalVolume()->GetMaterial();
+  const G4MaterialPropertiesTable* waterMPT = water->GetMaterialPropertiesTable();
+  if (waterMPT) {
+    if (auto absorption = waterMPT->GetProperty("ABSLENGTH")) {
+      fAbsorptionLength.Build(*absorption);
+    }
+    if (auto rayleigh = waterMPT->GetProperty("RAYLEIGH")) {
+      fRayleighLength.Build(*rayleigh);
+    }
+  }
+
+  fPropagator.Configure(detectorConstruction);
+}
+
+G4ClassificationOfNewTrack
+WaterTankStackingAction::ClassifyNewTrack(const G4Track* track)
+{
+  if (track->GetDefinition() != G4OpticalPhoton::OpticalPhotonDefinition()) {
+    return fUrgent;
+  }
+
+  // Table lookup already turned the emission into hits in the stepping action.
+  // Cerenkov stacking is off in this mode; this only catches photons that
+  // still appear in the water.
+  if (GetActiveResponseTable() && fGeometry.IsInWater(track->GetPosition())) {
+    return fKill;
+  }
+
+  // Photons born after the readout window closed can never be read out.
+  // The secondaries of a step are classified after the stepping action saw
+  // it, so the window already includes the charged particle that made them.
+  if (fDOMSD && fDOMSD->IsAfterWindow(track->GetGlobalTime())) {
+    fDOMSD->AddKilledLatePhoton();
+    return fKill;
+  }
+
+  // QE-first: thin the photon yield by the peak DOM efficiency right away.
+  if (fEmissionQE < 1. && G4UniformRand() >= fEmissionQE) {
+    return fKill;
+  }
+
+  // Photon bundles: keep one photon in fBundleSize and let it stand for the
+  // whole bundle through its weight, which the DOM SD copies into the hit.
+  if (fBundleSize > 1) {
+    if (G4UniformRand() * fBundleSize >= 1.) {
+      return fKill;
+    }
+    auto bundle = const_cast<G4Track*>(track);
+    bundle->SetWeight(track->GetWeight() * fBundleSize);
+  }
+
+  if (!fGeometry.IsConfigured()) {
+    return fUrgent;
+  }
+
+  // Photons born in the DOM glass or outside the tank water are left alone;
+  // the straight-line picture below only holds inside the water.
+  const G4ThreeVector& position = track->GetPosition();
+  if (!fGeometry.IsInWater(position)) {
+    return fUrgent;
+  }
+
+  if (fCullPhotons) {
+    fRunAction->AddCullingCandidate();
+
+    // A photon heading straight for the DOM is never culled. Below the
+    // threshold, Russian roulette keeps a photon with a chance proportional
+    // to its scatter-in estimate and divides its survival chance out of its
+    // weight, so the expected DOM hits stay the same.
+    if (fGeometry.DistanceToDOM(position, track->GetMomentumDirection()) == DBL_MAX) {
+      const G4double scatterIn = ScatterInProbability(track);
+      if (scatterIn < fCullThreshold) {
+        const G4double survival = std::max(scatterIn / fCullThreshold, kMinCullSurvival);
+        const G4double weight = track->GetWeight();
+        if (G4UniformRand() >= survival) {
+          fRunAction->AddCullRoulette(weight, 0.);
+          return fKill;
+        }
+        const_cast<G4Track*>(track)->SetWeight(weight / survival);
+        fRunAction->AddCullRoulette(weight, weight / survival);
+      }
+    }
+  }
+
+  if (fAnalyticPropagation && fDOMSD && fPropagator.IsConfigured()) {
+    PropagateAnalytically(track);
+    return fKill;
+  }
+
+  return fUrgent;
+}
+
+void WaterTankStackingAction::PropagateAnalytically(const G4Track* track)
+{
+  WaterTankPhotonPropagator::Photon photon;
+  photon.position  = track->GetPosition();
+  photon.direction = track->GetMomentumDirection();
+  photon.time      = track->GetGlobalTime();
+  photon.energy    = track->GetKineticEnergy();
+
+  // Same sequence as the dielectric_metal boundary during tracking: detect
+  // with the DOM efficiency, otherwise reflect with the surface reflectivity
+  // or be absorbed.
+  while (fPropagator.TransportToDOM(photon)) {
+    if (fDOMSD->SampleDetection(fDOMSD->GetDetectionProbability(photon.energy))) {
+      fDOMSD->AddHit(photon.time, photon.position, photon.direction, photon.energy,
+                     track->GetTrackID(), track->GetParentID(), track->GetWeight());
+      return;
+    }
+    if (!fPropagator.ReflectOffDOM(photon)) {
+      return;
+    }
+  }
+}
+
+G4double WaterTankStackingAction::ScatterInProbability(const G4Track* track) const
+{
+  const G4ThreeVector& position = track->GetPosition();
+  const G4double energy = track->GetKineticEnergy();
+
+  // Chance to Rayleigh scatter at all before the photon leaves the water.
+  G4double scatterProbability = 1.;
+  if (fRayleighLength.IsValid()) {
+    const G4double pathToWall
+      = fGeometry.DistanceToWall(position, track->GetMomentumDirection());
+    scatterProbability = 1. - std::exp(-pathToWall / fRayleighLength.Value(energy));
+  }
+
+  // Treat the scattered photon as isotropic from the birth point and ask it to
+  // survive absorption on its way to the DOM surface.
+  G4double survival = 1.;
+  if (fAbsorptionLength.IsValid()) {
+    const G4double distanceToDOM
+      = (position - fGeometry.GetDOMCenter()).mag() - fGeometry.GetDOMRadius();
+    survival = std::exp(-distanceToDOM / fAbsorptionLength.Value(energy));
+  }
+
+  return scatterProbability * fGeometry.DOMSolidAngleFraction(position) * survival;
+}
@@ -0,0 +1,165 @@
+/// \file WaterTankStackingMessenger.cc
+/// \brief Implementation of the WaterTankStackingMessenger class
+
+#include "WaterTankStackingMessenger.hh"
+#include "WaterTankStackingAction.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+
+WaterTankStackingMessenger::WaterTankStackingMessenger(WaterTankStackingAction* stackingAction)
+: G4UImessenger(),
+  fStackingAction(stackingAction)
+{
+  // Create directory for optical photon handling commands
+  fOpticsDirectory = new G4UIdirectory("/watertank/optics/");
+  fOpticsDirectory->SetGuidance("Optical photon handling and performance options");
+
+  // Command to enable geometric culling at birth
+  fCullPhotonsCmd = new G4UIcmdWithABool("/watertank/optics/cullPhotons", this);
+  fCullPhotonsCmd->SetGuidance("Roulette optical photons at birth if they are unlikely to reach the DOM");
+  fCullPhotonsCmd->SetGuidance("  Photons aimed at the DOM are always tracked. Others play Russian roulette");
+  fCullPhotonsCmd->SetGuidance("  when their estimated scatter-in probability is below cullThreshold:");
+  fCullPhotonsCmd->SetGuidance("  they survive with probability estimate/cullThreshold (at least 0.01)");
+  fCullPhotonsCmd->SetGuidance("  and survivors are weighted by its inverse, so hit counts stay unbiased.");
+  fCullPhotonsCmd->SetGuidance("  Culled photons are summarized at the end of each run.");
+  fCullPhotonsCmd->SetParameterName("cull", false);
+  fCullPhotonsCmd->SetDefaultValue(false);
+  fCullPhotonsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to set the culling threshold
+  fCullThresholdCmd = new G4UIcmdWithADouble("/watertank/optics/cullThreshold", this);
+  fCullThresholdCmd->SetGuidance("Scatter-in probability below which photons missing the DOM are culled");
+  fCullThresholdCmd->SetGuidance("Default 0.01 puts practically every photon that misses the DOM to roulette");
+  fCullThresholdCmd->SetParameterName("threshold", false);
+  fCullThresholdCmd->SetRange("threshold >= 0. && threshold <= 1.");
+  fCullThresholdCmd->SetDefaultValue(1.e-2);
+  fCullThresholdCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to pre-apply the DOM quantum efficiency at emission
+  fQEFirstCmd = new G4UIcmdWithABool("/watertank/optics/qeFirst", this);
+  fQEFirstCmd->SetGuidance("Thin optical photons by the peak DOM efficiency when they are created");
+  fQEFirstCmd->SetGuidance("  The DOM then samples only the relative efficiency QE(E)/QEmax,");
+  fQEFirstCmd->SetGuidance("  giving the same hit statistics with ~1/QEmax fewer tracked photons.");
+  fQEFirstCmd->SetParameterName("qeFirst", false);
+  fQEFirstCmd->SetDefaultValue(false);
+  fQEFirstCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to trace optical photons analytically instead of with Geant4
+  fAnalyticPropagationCmd = new G4UIcmdWithABool("/watertank/optics/analyticPropagation", this);
+  fAnalyticPropagationCmd->SetGuidance("Ray-trace optical photons born in the water instead of tracking them");
+  fAnalyticPropagationCmd->SetGuidance("  Absorption, Rayleigh scattering, DOM efficiency and reflectivity are");
+  fAnalyticPropagationCmd->SetGuidance("  sampled from the same tables; hits go to the DOM hits collection.");
+  fAnalyticPropagationCmd->SetGuidance("  Photons no longer appear as tracks (e.g. in visualization).");
+  fAnalyticPropagationCmd->SetParameterName("analytic", false);
+  fAnalyticPropagationCmd->SetDefaultValue(false);
+  fAnalyticPropagationCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to load a precomputed DOM response table
+  fResponseTableCmd = new G4UIcmdWithAString("/watertank/optics/responseTable", this);
+  fResponseTableCmd->SetGuidance("Load a DOM response table written by buildResponseTable");
+  fResponseTableCmd->SetGuidance("  The table must have been built for the current geometry.");
+  fResponseTableCmd->SetParameterName("fileName", false);
+  fResponseTableCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to replace photon tracking by response table lookup
+  fTableLookupCmd = new G4UIcmdWithABool("/watertank/optics/tableLookup", this);
+  fTableLookupCmd->SetGuidance("Turn the Cherenkov emission of charged steps into DOM hits by table lookup");
+  fTableLookupCmd->SetGuidance("  Requires /watertank/optics/responseTable. G4Cerenkov stacks no");
+  fTableLookupCmd->SetGuidance("  optical photons in this mode, and QE-first is ignored.");
+  fTableLookupCmd->SetParameterName("lookup", false);
+  fTableLookupCmd->SetDefaultValue(false);
+  fTableLookupCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to set the photon bundle size
+  fBundleSizeCmd = new G4UIcmdWithAnInteger("/watertank/optics/bundleSize", this);
+  fBundleSizeCmd->SetGuidance("Number of physical photons carried by each tracked optical photon");
+  fBundleSizeCmd->SetGuidance("  One photon in N is tracked with weight N; DOMHitCount becomes the");
+  fBundleSizeCmd->SetGuidance("  weighted hit sum and DOMHitCountVar its variance. 1 disables bundling.");
+  fBundleSizeCmd->SetParameterName("size", false);
+  fBundleSizeCmd->SetRange("size >= 1");
+  fBundleSizeCmd->SetDefaultValue(1);
+  fBundleSizeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Command to set the readout window
+  fTimeWindowCmd = new G4UIcmdWithADoubleAndUnit("/watertank/optics/timeWindow", this);
+  fTimeWindowCmd->SetGuidance("Readout window after the first charged particle enters the water");
+  fTimeWindowCmd->SetGuidance("  Optical photons and DOM hits after the window are dropped and");
+  fTimeWindowCmd->SetGuidance("  counted in the KilledLatePhotons event column. 0 disables it.");
+  fTimeWindowCmd->SetParameterName("window", false);
+  fTimeWindowCmd->SetRange("window >= 0.");
+  fTimeWindowCmd->SetDefaultValue(0.);
+  fTimeWindowCmd->SetDefaultUnit("ns");
+  fTimeWindowCmd->SetUnitCategory("Time");
+  fTimeWindowCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // Commands to configure Russian roulette of long photon histories
+  fRouletteIntervalCmd = new G4UIcmdWithAnInteger("/watertank/optics/rouletteInterval", this);
+  fRouletteIntervalCmd->SetGuidance("Play Russian roulette with an optical photon every N scatters");
+  fRouletteIntervalCmd->SetGuidance("  or boundary interactions; survivors carry the killed weight.");
+  fRouletteIntervalCmd->SetGuidance("  0 disables roulette.");
+  fRouletteIntervalCmd->SetParameterName("interactions", false);
+  fRouletteIntervalCmd->SetRange("interactions >= 0");
+  fRouletteIntervalCmd->SetDefaultValue(0);
+  fRouletteIntervalCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fRouletteSurvivalCmd = new G4UIcmdWithADouble("/watertank/optics/rouletteSurvival", this);
+  fRouletteSurvivalCmd->SetGuidance("Survival probability of an optical photon at each roulette");
+  fRouletteSurvivalCmd->SetParameterName("probability", false);
+  fRouletteSurvivalCmd->SetRange("probability > 0. && probability <= 1.");
+  fRouletteSurvivalCmd->SetDefaultValue(0.5);
+  fRouletteSurvivalCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+WaterTankStackingMessenger::~WaterTankStackingMessenger()
+{
+  delete fCullPhotonsCmd;
+  delete fCullThresholdCmd;
+  delete fQEFirstCmd;
+  delete fAnalyticPropagationCmd;
+  delete fResponseTableCmd;
+  delete fTableLookupCmd;
+  delete fBundleSizeCmd;
+  delete fTimeWindowCmd;
+  delete fRouletteIntervalCmd;
+  delete fRouletteSurvivalCmd;
+  delete fOpticsDirectory;
+}
+
+void WaterTankStackingMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if (command == fCullPhotonsCmd) {
+    fStackingAction->SetCullPhotons(fCullPhotonsCmd->GetNewBoolValue(newValue));
+  }
+  else if (command == fCullThresholdCmd) {
+    fStackingAction->SetCullThreshold(fCullThresholdCmd->GetNewDoubleValue(newValue));
+  }
+  else if (command == fQEFirstCmd) {
+    fStackingAction->SetQEFirst(fQEFirstCmd->GetNewBoolValue(newValue));
+  }
+  else if (command == fAnalyticPropagationCmd) {
+    fStackingAction->SetAnalyticPropagation(fAnalyticPropagationCmd->GetNewBoolValue(newValue));
+  }
+  else if (command == fResponseTableCmd) {
+    fStackingAction->LoadResponseTable(newValue);
+  }
+  else if (command == fTableLookupCmd) {
+    fStackingAction->SetTableLookup(fTableLookupCmd->GetNewBoolValue(newValue));
+  }
+  else if (command == fBundleSizeCmd) {
+    fStackingAction->SetBundleSize(fBundleSizeCmd->GetNewIntValue(newValue));
+  }
+  else if (command == fTimeWindowCmd) {
+    fStackingAction->SetTimeWindow(fTimeWindowCmd->GetNewDoubleValue(newValue));
+  }
+  else if (command == fRouletteIntervalCmd) {
+    fStackingAction->SetRouletteInterval(fRouletteIntervalCmd->GetNewIntValue(newValue));
+  }
+  else if (command == fRouletteSurvivalCmd) {
+    fStackingAction->SetRouletteSurvival(fRouletteSurvivalCmd->GetNewDoubleValue(newValue));
+  }
+}
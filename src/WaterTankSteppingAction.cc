@@ -3,18 +3,46 @@
 
 #include "WaterTankSteppingAction.hh"
 #include "WaterTankEventAction.hh"
+#include "WaterTankRunAction.hh"
 #include "WaterTankDetectorConstruction.hh"
+#include "WaterTankDOMSD.hh"
+#include "WaterTankStackingAction.hh"
+#include "WaterTankResponseTable.hh"
+#include "WaterTankCherenkov.hh"
 
 #include "G4Step.hh"
 #include "G4Event.hh"
 #include "G4RunManager.hh"
 #include "G4LogicalVolume.hh"
 #include "G4OpticalPhoton.hh"
+#include "G4Material.hh"
+#include "G4MaterialPropertiesTable.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Poisson.hh"
+#include "G4VProcess.hh"
+#include "G4OpProcessSubType.hh"
+#include "Randomize.hh"
 
-WaterTankSteppingAction::WaterTankSteppingAction(WaterTankEventAction* eventAction)
+#include <cmath>
+
+namespace
+{
+  // Energy subdivisions used to integrate the Cherenkov yield.
+  const G4int kYieldSteps = 64;
+}
+
+WaterTankSteppingAction::WaterTankSteppingAction(WaterTankRunAction* runAction,
+                                                 WaterTankEventAction* eventAction,
+                                                 WaterTankStackingAction* stackingAction)
 : G4UserSteppingAction(),
   fEventAction(eventAction),
-  fScoringVolume(0)
+  fRunAction(runAction),
+  fScoringVolume(0),
+  fWaterPhysicalVolume(nullptr),
+  fDOMSD(nullptr),
+  fStackingAction(stackingAction),
+  fPhotonInteractions(0)
 {}
 
 WaterTankSteppingAction::~WaterTankSteppingAction()
@@ -29,6 +57,50 @@ void WaterTankSteppingAction::UserSteppingAction(const G4Step* step)
       = static_cast<const WaterTankDetectorConstruction*>
         (G4RunManager::GetRunManager()->GetUserDetectorConstruction());
     fScoringVolume = detectorConstruction->GetScoringVolume();   
+    fWaterPhysicalVolume = detectorConstruction->GetWaterPhysicalVolume();
+    fDOMSD = WaterTankDOMSD::Instance();
+    const G4MaterialPropertiesTable* waterMPT
+      = detectorConstruction->GetWaterLogicalVolume()->GetMaterial()->GetMaterialPropertiesTable();
+    if (waterMPT && waterMPT->GetProperty("RINDEX")) {
+      fRefractiveIndex.Build(*waterMPT->GetProperty("RINDEX"));
+    }
+  }
+
+  // Optical photons never contribute to calorimetry. The only thing we care
+  // about is whether a step leaving the water ended on the DOM boundary, which
+  // is a cheap status/volume check compared to a full SD dispatch per step.
+  if (step->GetTrack()->GetDefinition() == G4OpticalPhoton::OpticalPhotonDefinition()) {
+    // Readout window: photons that are still around after it closes cannot
+    // produce a hit that is read out, so stop tracking them.
+    if (fDOMSD && fDOMSD->IsAfterWindow(step->GetPostStepPoint()->GetGlobalTime())) {
+      step->GetTrack()->SetTrackStatus(fStopAndKill);
+      fDOMSD->AddKilledLatePhoton();
+      return;
+    }
+    if (fDOMSD
+        && step->GetPostStepPoint()->GetStepStatus() == fGeomBoundary
+        && step->GetPreStepPoint()->GetPhysicalVolume() == fWaterPhysicalVolume) {
+      fDOMSD->ProcessBoundaryHit(step);
+    }
+    if (fStackingAction && fStackingAction->GetRouletteInterval() > 0
+        && step->GetTrack()->GetTrackStatus() == fAlive) {
+      PlayRoulette(step);
+    }
+    return;
+  }
+
+  // The readout window opens when the first charged particle is in the water.
+  if (fDOMSD && step->GetPreStepPoint()->GetPhysicalVolume() == fWaterPhysicalVolume
+      && step->GetTrack()->GetDefinition()->GetPDGCharge() != 0.) {
+    fDOMSD->MarkWaterEntry(step->GetPreStepPoint()->GetGlobalTime());
+  }
+
+  // Table lookup: this step's Cherenkov light goes straight to DOM hits.
+  if (fStackingAction && fDOMSD && fRefractiveIndex.IsValid()
+      && step->GetPreStepPoint()->GetPhysicalVolume() == fWaterPhysicalVolume) {
+    if (const WaterTankResponseTable* table = fStackingAction->GetActiveResponseTable()) {
+      GenerateTableHits(step, *table);
+    }
   }
 
   // get volume of the current step
@@ -39,13 +111,109 @@ void WaterTankSteppingAction::UserSteppingAction(const G4Step* step)
   // check if we are in scoring volume
   if (volume != fScoringVolume) return;
 
-  // collect energy deposited in this step
-  // Do not count optical photons in calorimetry
-  if (step->GetTrack()->GetDefinition() == G4OpticalPhoton::OpticalPhotonDefinition()) {
-    return;
-  }
   // Feed the energy deposit to the event action which will forward it to the
   // run action at the end of the event. This supports both ST and MT modes.
   G4double edepStep = step->GetTotalEnergyDeposit();
   fEventAction->AddEdep(edepStep);
 }
+
+void WaterTankSteppingAction::GenerateTableHits(const G4Step* step,
+                                                const WaterTankResponseTable& table)
+{
+  const G4double charge = step->GetTrack()->GetDefinition()->GetPDGCharge();
+  if (charge == 0.) return;
+
+  const G4StepPoint* prePoint  = step->GetPreStepPoint();
+  const G4StepPoint* postPoint = step->GetPostStepPoint();
+
+  // Steps made by the muon fast-simulation model already produced their light.
+  const G4VProcess* process = postPoint->GetProcessDefinedStep();
+  if (process && process->GetProcessType() == fParameterisation) return;
+  const G4double betaInverse = 2. / (prePoint->GetBeta() + postPoint->GetBeta());
+  const G4double maxIndex = fRefractiveIndex.GetMaxValue();
+  if (betaInverse >= maxIndex) return;
+
+  // Mean photon count per unit length: integrate 1 - 1/(beta n)^2 over the
+  // energies where the particle is above threshold.
+  const G4double energyMin = fRefractiveIndex.GetMinEnergy();
+  const G4double energyMax = fRefractiveIndex.GetMaxEnergy();
+  const G4double dEnergy = (energyMax - energyMin) / kYieldSteps;
+  G4double integral = 0.;
+  for (G4int i = 0; i < kYieldSteps; ++i) {
+    const G4double n = fRefractiveIndex.Value(energyMin + (i + 0.5) * dEnergy);
+    const G4double cosTheta = betaInverse / n;
+    if (cosTheta < 1.) integral += (1. - cosTheta*cosTheta) * dEnergy;
+  }
+  const G4double meanPhotons = WaterTankCherenkov::kYield * (charge/eplus) * (charge/eplus)
+                             * integral * step->GetStepLength();
+  const G4long nPhotons = G4Poisson(meanPhotons);
+  if (nPhotons == 0) return;
+
+  const G4ThreeVector startPosition = prePoint->GetPosition();
+  const G4ThreeVector displacement  = postPoint->GetPosition() - startPosition;
+  const G4double startTime = prePoint->GetGlobalTime();
+  const G4double duration  = postPoint->GetGlobalTime() - startTime;
+  const G4ThreeVector trackDirection = displacement.unit();
+  const G4double maxCos  = betaInverse / maxIndex;
+  const G4double maxSin2 = (1. - maxCos) * (1. + maxCos);
+  const G4ThreeVector domCenter(0., 0., table.GetDOMCenterZ());
+  const G4int parentID = step->GetTrack()->GetTrackID();
+
+  for (G4long i = 0; i < nPhotons; ++i) {
+    // Energy and cone angle sampled as in G4Cerenkov::PostStepDoIt.
+    G4double energy, cosTheta, sin2Theta;
+    do {
+      energy = energyMin + G4UniformRand() * (energyMax - energyMin);
+      cosTheta = betaInverse / fRefractiveIndex.Value(energy);
+      sin2Theta = (1. - cosTheta) * (1. + cosTheta);
+    } while (G4UniformRand() * maxSin2 > sin2Theta);
+
+    const G4double phi = twopi * G4UniformRand();
+    const G4double sinTheta = std::sqrt(sin2Theta);
+    G4ThreeVector direction(sinTheta*std::cos(phi), sinTheta*std::sin(phi), cosTheta);
+    direction.rotateUz(trackDirection);
+
+    const G4double fraction = G4UniformRand();
+    const G4ThreeVector position = startPosition + fraction * displacement;
+
+    const G4double probability = table.GetArrivalProbability(position, direction, energy)
+                               * fDOMSD->GetDetectionProbability(energy);
+    if (!fDOMSD->SampleDetection(probability)) continue;
+
+    // The table does not resolve where on the DOM the photon lands; record
+    // it on the side facing the emission point.
+    const G4ThreeVector towardsEmission = (position - domCenter).unit();
+    fDOMSD->AddHit(startTime + fraction * duration + table.SampleArrivalDelay(position, direction),
+                   domCenter + table.GetDOMRadius() * towardsEmission, -towardsEmission,
+                   energy, 0, parentID);
+  }
+}
+
+void WaterTankSteppingAction::PlayRoulette(const G4Step* step)
+{
+  G4Track* track = step->GetTrack();
+  if (track->GetCurrentStepNumber() == 1) fPhotonInteractions = 0;
+
+  // Interactions that lengthen a photon's history: scatters in the water and
+  // reflections/refractions at any surface.
+  const G4StepPoint* postPoint = step->GetPostStepPoint();
+  const G4VProcess* process = postPoint->GetProcessDefinedStep();
+  const G4bool scattered = process && process->GetProcessType() == fOptical
+    && (process->GetProcessSubType() == fOpRayleigh
+        || process->GetProcessSubType() == fOpMieHG);
+  if (!scattered && postPoint->GetStepStatus() != fGeomBoundary) return;
+
+  if (++fPhotonInteractions % fStackingAction->GetRouletteInterval() != 0) return;
+
+  const G4double weight = track->GetWeight();
+  const G4double survival = fStackingAction->GetRouletteSurvival();
+  G4double newWeight = 0.;
+  if (G4UniformRand() < survival) {
+    newWeight = weight / survival;
+    track->SetWeight(newWeight);
+  }
+  else {
+    track->SetTrackStatus(fStopAndKill);
+  }
+  if (fRunAction) fRunAction->AddRoulette(weight, newWeight);
+}
@@ -0,0 +1,126 @@
+/// \file WaterTankTimeStatistics.cc
+/// \brief Implementation of the WaterTankTimeStatistics class
+
+#include "WaterTankTimeStatistics.hh"
+
+#include <algorithm>
+#include <cmath>
+
+WaterTankTimeStatistics::WaterTankTimeStatistics()
+: fSumWeight(0.),
+  fSumWeight2(0.),
+  fMin(0.),
+  fMax(0.),
+  fMean(0.),
+  fRMS(0.),
+  fMedian(0.)
+{}
+
+void WaterTankTimeStatistics::Compute(const G4double* times, const float* weights, std::size_t n,
+                                      const std::vector<G4double>& quantiles)
+{
+  fSumWeight = fSumWeight2 = 0.;
+  fMin = fMax = fMean = fRMS = fMedian = 0.;
+  fQuantiles.assign(quantiles.size(), 0.);
+  if (n == 0) return;
+
+  // First pass: weight sums, weighted time sum, min and max. The scratch
+  // copy for the selections is filled on the way.
+  fScratch.resize(n);
+  G4double sumWeight = 0.;
+  G4double sumWeight2 = 0.;
+  G4double sumTime = 0.;
+  G4double minTime = times[0];
+  G4double maxTime = times[0];
+  for (std::size_t i = 0; i < n; ++i) {
+    const G4double t = times[i];
+    const float w = weights[i];
+    sumWeight += w;
+    sumWeight2 += G4double(w) * w;
+    sumTime += w * t;
+    minTime = t < minTime ? t : minTime;
+    maxTime = t > maxTime ? t : maxTime;
+    fScratch[i].time = t;
+    fScratch[i].weight = w;
+  }
+  fSumWeight = sumWeight;
+  fSumWeight2 = sumWeight2;
+  fMin = minTime;
+  fMax = maxTime;
+  if (sumWeight <= 0.) return;
+  fMean = sumTime / sumWeight;
+
+  // Second pass: variance around the mean.
+  const G4double mean = fMean;
+  G4double sumDev2 = 0.;
+  for (std::size_t i = 0; i < n; ++i) {
+    const G4double d = times[i] - mean;
+    sumDev2 += weights[i] * d * d;
+  }
+  fRMS = std::sqrt(sumDev2 / sumWeight);
+
+  // Quantiles in increasing order, with the median (slot -1) among them.
+  fOrder.clear();
+  fOrder.emplace_back(0.5, -1);
+  for (std::size_t i = 0; i < quantiles.size(); ++i) {
+    fOrder.emplace_back(quantiles[i], G4int(i));
+  }
+  std::sort(fOrder.begin(), fOrder.end());
+
+  std::size_t lo = 0;
+  G4double below = 0.;
+  for (const auto& entry : fOrder) {
+    const G4double value = Quantile(entry.first * sumWeight, lo, below);
+    if (entry.second < 0) fMedian = value;
+    else fQuantiles[entry.second] = value;
+  }
+}
+
+std::size_t WaterTankTimeStatistics::Select(G4double target, std::size_t& lo, G4double& below)
+{
+  // Quickselect on weights. Entries before lo are no later than those in
+  // [lo, hi), which are no later than those from hi on, and `below` is the
+  // weight before lo; each step partitions around the middle of the range.
+  const auto byTime = [](const TimedWeight& a, const TimedWeight& b) { return a.time < b.time; };
+  std::size_t hi = fScratch.size();
+  while (hi - lo > 1) {
+    const std::size_t mid = lo + (hi - lo) / 2;
+    std::nth_element(fScratch.begin() + lo, fScratch.begin() + mid, fScratch.begin() + hi, byTime);
+    G4double left = below;
+    for (std::size_t i = lo; i < mid; ++i) left += fScratch[i].weight;
+    if (left >= target) {
+      hi = mid;
+    }
+    else if (left + fScratch[mid].weight >= target) {
+      lo = mid;
+      below = left;
+      return mid;
+    }
+    else {
+      lo = mid + 1;
+      below = left + fScratch[mid].weight;
+    }
+  }
+  // Rounding can leave the target just above the weight of the range; the
+  // pivot handled last is then the entry to return.
+  if (lo == hi) {
+    --lo;
+    below -= fScratch[lo].weight;
+  }
+  return lo;
+}
+
+G4double WaterTankTimeStatistics::Quantile(G4double target, std::size_t& lo, G4double& below)
+{
+  const std::size_t k = Select(target, lo, below);
+  const G4double value = fScratch[k].time;
+  if (below + fScratch[k].weight != target || k + 1 == fScratch.size()) return value;
+
+  // The cumulative weight lands exactly on the target: average with the next
+  // time, the earliest of the entries after k.
+  G4double next = fScratch[k + 1].time;
+  for (std::size_t i = k + 2; i < fScratch.size(); ++i) {
+    next = fScratch[i].time < next ? fScratch[i].time : next;
+  }
+  return 0.5 * (value + next);
+}